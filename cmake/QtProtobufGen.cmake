@@ -8,7 +8,7 @@ function(qtprotobuf_link_target target generated_target)
 endfunction()
 
 function(qtprotobuf_generate)
-    set(options MULTI QML COMMENTS FOLDER FIELDENUM)
+    set(options MULTI QML COMMENTS FOLDER FIELDENUM DIRECT_SERIALIZATION LAZY_PARSING)
     set(oneValueArgs OUTPUT_DIRECTORY TARGET GENERATED_TARGET EXTRA_NAMESPACE)
     set(multiValueArgs EXCLUDE_HEADERS PROTO_FILES PROTO_INCLUDES)
     cmake_parse_arguments(arg "${options}" "${oneValueArgs}" "${multiValueArgs}" ${ARGN})
@@ -65,6 +65,16 @@ function(qtprotobuf_generate)
         list(APPEND generation_options "FIELDENUM")
     endif()
 
+    if(arg_DIRECT_SERIALIZATION)
+        message(STATUS "Enabling DIRECT_SERIALIZATION generation for ${generated_target_name}")
+        list(APPEND generation_options "DIRECT_SERIALIZATION")
+    endif()
+
+    if(arg_LAZY_PARSING)
+        message(STATUS "Enabling LAZY_PARSING generation for ${generated_target_name}")
+        list(APPEND generation_options "LAZY_PARSING")
+    endif()
+
     list(JOIN generation_options ":" generation_options_string)
     if(arg_EXTRA_NAMESPACE)
         set(generation_options_string "${generation_options_string}:EXTRA_NAMESPACE=\"${arg_EXTRA_NAMESPACE}\"")
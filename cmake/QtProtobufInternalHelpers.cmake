@@ -14,7 +14,7 @@ function(qtprotobuf_parse_arguments prefix option single multi)
 endfunction()
 
 function(qt_protobuf_internal_add_test)
-    set(options MULTI QML FIELDENUM)
+    set(options MULTI QML FIELDENUM DIRECT_SERIALIZATION LAZY_PARSING)
     set(oneValueArgs QML_DIR TARGET EXTRA_NAMESPACE)
     set(multiValueArgs SOURCES EXCLUDE_HEADERS PROTO_FILES PROTO_INCLUDES)
     cmake_parse_arguments(add_test_target "${options}" "${oneValueArgs}" "${multiValueArgs}" ${ARGN})
@@ -45,6 +45,12 @@ function(qt_protobuf_internal_add_test)
     if(add_test_target_FIELDENUM)
         set(EXTRA_OPTIONS ${EXTRA_OPTIONS} FIELDENUM)
     endif()
+    if(add_test_target_DIRECT_SERIALIZATION)
+        set(EXTRA_OPTIONS ${EXTRA_OPTIONS} DIRECT_SERIALIZATION)
+    endif()
+    if(add_test_target_LAZY_PARSING)
+        set(EXTRA_OPTIONS ${EXTRA_OPTIONS} LAZY_PARSING)
+    endif()
     if(add_test_target_EXTRA_NAMESPACE)
         set(EXTRA_OPTIONS ${EXTRA_OPTIONS} EXTRA_NAMESPACE ${add_test_target_EXTRA_NAMESPACE})
     endif()
@@ -27,6 +27,7 @@
 #include "generatoroptions.h"
 
 #include <assert.h>
+#include <set>
 
 using namespace ::QtProtobuf::generator;
 using namespace ::google::protobuf;
@@ -277,6 +278,60 @@ bool common::isPureMessage(const ::google::protobuf::FieldDescriptor *field)
     return field->type() == FieldDescriptor::TYPE_MESSAGE && !field->is_map() && !field->is_repeated() && !common::isQtType(field);
 }
 
+bool common::isLazyString(const ::google::protobuf::FieldDescriptor *field)
+{
+    return GeneratorOptions::instance().generateLazyParsing() && field->type() == FieldDescriptor::TYPE_STRING
+            && !field->is_repeated() && hasDirectSerialization(field->containing_type());
+}
+
+namespace {
+bool isDirectSerializable(const Descriptor *message, std::set<const Descriptor *> &visited)
+{
+    //Message is already checked or is being checked in case of recursive types
+    if (!visited.insert(message).second) {
+        return true;
+    }
+
+    for (int i = 0; i < message->field_count(); i++) {
+        const FieldDescriptor *field = message->field(i);
+        if (field->is_map()) {
+            return false;
+        }
+
+        switch (field->type()) {
+        case FieldDescriptor::TYPE_MESSAGE:
+            //Nested messages must be generated in the same file to have serializeTo/parseFrom methods
+            if (field->is_repeated() || common::isQtType(field)
+                    || field->message_type()->file() != message->file()
+                    || !isDirectSerializable(field->message_type(), visited)) {
+                return false;
+            }
+            break;
+        case FieldDescriptor::TYPE_GROUP:
+            return false;
+        case FieldDescriptor::TYPE_BOOL:
+            if (field->is_repeated()) {
+                return false;
+            }
+            break;
+        default:
+            break;
+        }
+    }
+    return true;
+}
+}
+
+bool common::hasDirectSerialization(const Descriptor *message)
+{
+    if (!GeneratorOptions::instance().generateDirectSerialization()) {
+        return false;
+    }
+
+    std::set<const Descriptor *> visited;
+    return isDirectSerializable(message, visited);
+}
+
 TypeMap common::produceTypeMap(const FieldDescriptor *field, const Descriptor *scope)
 {
     TypeMap typeMap;
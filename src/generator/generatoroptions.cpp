@@ -34,6 +34,8 @@ static const std::string QmlPluginOption("QML");
 static const std::string CommentsGenerationOption("COMMENTS");
 static const std::string FolderGenerationOption("FOLDER");
 static const std::string FieldEnumGenerationOption("FIELDENUM");
+static const std::string DirectSerializationGenerationOption("DIRECT_SERIALIZATION");
+static const std::string LazyParsingGenerationOption("LAZY_PARSING");
 static const std::string ExtraNamespaceGenerationOption("EXTRA_NAMESPACE");
 
 using namespace ::QtProtobuf::generator;
@@ -43,6 +45,8 @@ GeneratorOptions::GeneratorOptions() : mIsMulti(false)
   , mGenerateComments(false)
   , mIsFolder(false)
   , mGenerateFieldEnum(false)
+  , mGenerateDirectSerialization(false)
+  , mGenerateLazyParsing(false)
 {
 }
 
@@ -66,6 +70,12 @@ void GeneratorOptions::parseFromEnv(const std::string &options)
         } else if (option.compare(FieldEnumGenerationOption) == 0) {
             QT_PROTOBUF_DEBUG("set mGenerateFieldEnum: true");
             mGenerateFieldEnum = true;
+        } else if (option.compare(DirectSerializationGenerationOption) == 0) {
+            QT_PROTOBUF_DEBUG("set mGenerateDirectSerialization: true");
+            mGenerateDirectSerialization = true;
+        } else if (option.compare(LazyParsingGenerationOption) == 0) {
+            QT_PROTOBUF_DEBUG("set mGenerateLazyParsing: true");
+            mGenerateLazyParsing = true;
         } else if (option.find(ExtraNamespaceGenerationOption) == 0) {
             QT_PROTOBUF_DEBUG("set mGenerateFieldEnum: true");
             std::vector<std::string> compositeOption = utils::split(options, '=');
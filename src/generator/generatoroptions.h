@@ -51,6 +51,8 @@ public:
     bool generateComments() const { return mGenerateComments; }
     bool isFolder() const { return mIsFolder; }
     bool generateFieldEnum() const { return mGenerateFieldEnum; }
+    bool generateDirectSerialization() const { return mGenerateDirectSerialization; }
+    bool generateLazyParsing() const { return mGenerateLazyParsing; }
     const std::string &extraNamespace() const { return mExtraNamespace; }
 
 private:
@@ -59,6 +61,8 @@ private:
     bool mGenerateComments;
     bool mIsFolder;
     bool mGenerateFieldEnum;
+    bool mGenerateDirectSerialization;
+    bool mGenerateLazyParsing;
     std::string mExtraNamespace;
 };
 
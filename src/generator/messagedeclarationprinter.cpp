@@ -404,6 +404,9 @@ void MessageDeclarationPrinter::printClassBody()
 
     Indent();
     mPrinter->Print(mTypeMap, Templates::ManualRegistrationDeclaration);
+    if (common::hasDirectSerialization(mDescriptor)) {
+        mPrinter->Print(mTypeMap, Templates::DirectSerializationDeclarationTemplate);
+    }
     Outdent();
 
     printSignalsBlock();
@@ -429,6 +432,8 @@ void MessageDeclarationPrinter::printClassMembers()
     common::iterateMessageFields(mDescriptor, [&](const FieldDescriptor *field, const PropertyMap &propertyMap) {
         if (common::isPureMessage(field)) {
             mPrinter->Print(propertyMap, Templates::ComplexMemberTemplate);
+        } else if (common::isLazyString(field)) {
+            mPrinter->Print(propertyMap, Templates::LazyStringMemberTemplate);
         } else if (field->is_repeated() && !field->is_map()) {
              mPrinter->Print(propertyMap, Templates::ListMemberTemplate);
         } else {
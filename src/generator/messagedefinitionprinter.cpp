@@ -28,6 +28,9 @@
 #include <google/protobuf/descriptor.h>
 #include "generatoroptions.h"
 
+#include <algorithm>
+#include <vector>
+
 using namespace QtProtobuf::generator;
 using namespace ::google::protobuf;
 
@@ -56,6 +59,7 @@ void MessageDefinitionPrinter::printClassDefinitionPrivate()
     printMoveSemantic();
     printComparisonOperators();
     printGetters();
+    printDirectSerialization();
 }
 
 void MessageDefinitionPrinter::printClassDefinition()
@@ -201,15 +205,7 @@ void MessageDefinitionPrinter::printCopyFunctionality()
 {
     assert(mDescriptor != nullptr);
 
-    const char *constructorTemplate = Templates::CopyConstructorDefinitionTemplate;
-    const char *assignmentOperatorTemplate = Templates::AssignmentOperatorDefinitionTemplate;
-    if (mDescriptor->field_count() <= 0) {
-        constructorTemplate = Templates::EmptyCopyConstructorDefinitionTemplate;
-        assignmentOperatorTemplate = Templates::EmptyAssignmentOperatorDefinitionTemplate;
-    }
-
-    mPrinter->Print(mTypeMap,
-                    constructorTemplate);
+    mPrinter->Print(mTypeMap, Templates::CopyConstructorDefinitionTemplate);
     common::iterateMessageFields(mDescriptor, [&](const FieldDescriptor *field, const PropertyMap &propertyMap) {
         if (common::isPureMessage(field)) {
             mPrinter->Print(propertyMap, Templates::MessagePropertyDefaultInitializerTemplate);
@@ -221,22 +217,29 @@ void MessageDefinitionPrinter::printCopyFunctionality()
     common::iterateMessageFields(mDescriptor, [&](const FieldDescriptor *field, const PropertyMap &propertyMap) {
         if (common::isPureMessage(field)) {
             mPrinter->Print(propertyMap, Templates::CopyComplexFieldTemplate);
+        } else if (common::isLazyString(field)) {
+            //Copy UTF-8 data as is, without decoding
+            mPrinter->Print(propertyMap, Templates::CopyLazyStringFieldTemplate);
         } else {
             mPrinter->Print(propertyMap, Templates::CopyFieldTemplate);
         }
     });
+    mPrinter->Print(Templates::CopyUnknownFieldsTemplate);
     Outdent();
     mPrinter->Print(Templates::SimpleBlockEnclosureTemplate);
 
-    mPrinter->Print(mTypeMap, assignmentOperatorTemplate);
+    mPrinter->Print(mTypeMap, Templates::AssignmentOperatorDefinitionTemplate);
     Indent();
     common::iterateMessageFields(mDescriptor, [&](const FieldDescriptor *field, const PropertyMap &propertyMap) {
         if (common::isPureMessage(field)) {
             mPrinter->Print(propertyMap, Templates::AssignComplexFieldTemplate);
+        } else if (common::isLazyString(field)) {
+            mPrinter->Print(propertyMap, Templates::AssignLazyStringFieldTemplate);
         } else {
             mPrinter->Print(propertyMap, Templates::CopyFieldTemplate);
         }
     });
+    mPrinter->Print(Templates::CopyUnknownFieldsTemplate);
     mPrinter->Print(Templates::AssignmentOperatorReturnTemplate);
     Outdent();
     mPrinter->Print(Templates::SimpleBlockEnclosureTemplate);
@@ -246,15 +249,7 @@ void MessageDefinitionPrinter::printMoveSemantic()
 {
     assert(mDescriptor != nullptr);
 
-    const char *constructorTemplate = Templates::MoveConstructorDefinitionTemplate;
-    const char *assignmentOperatorTemplate = Templates::MoveAssignmentOperatorDefinitionTemplate;
-    if (mDescriptor->field_count() <= 0) {
-        constructorTemplate = Templates::EmptyMoveConstructorDefinitionTemplate;
-        assignmentOperatorTemplate = Templates::EmptyMoveAssignmentOperatorDefinitionTemplate;
-    }
-
-    mPrinter->Print(mTypeMap,
-                    constructorTemplate);
+    mPrinter->Print(mTypeMap, Templates::MoveConstructorDefinitionTemplate);
     common::iterateMessageFields(mDescriptor, [&](const FieldDescriptor *field, const PropertyMap &propertyMap) {
         if (common::isPureMessage(field)) {
             mPrinter->Print(propertyMap, Templates::MessagePropertyDefaultInitializerTemplate);
@@ -282,10 +277,11 @@ void MessageDefinitionPrinter::printMoveSemantic()
             }
         }
     });
+    mPrinter->Print(Templates::MoveUnknownFieldsTemplate);
     Outdent();
     mPrinter->Print(Templates::SimpleBlockEnclosureTemplate);
 
-    mPrinter->Print(mTypeMap, assignmentOperatorTemplate);
+    mPrinter->Print(mTypeMap, Templates::MoveAssignmentOperatorDefinitionTemplate);
     Indent();
     common::iterateMessageFields(mDescriptor, [&](const FieldDescriptor *field, const PropertyMap &propertyMap) {
         if (field->type() == FieldDescriptor::TYPE_MESSAGE
@@ -306,6 +302,7 @@ void MessageDefinitionPrinter::printMoveSemantic()
             }
         }
     });
+    mPrinter->Print(Templates::MoveUnknownFieldsTemplate);
     mPrinter->Print(Templates::AssignmentOperatorReturnTemplate);
     Outdent();
     mPrinter->Print(Templates::SimpleBlockEnclosureTemplate);
@@ -387,6 +384,57 @@ void MessageDefinitionPrinter::printGetters()
     });
 }
 
+void MessageDefinitionPrinter::printDirectSerialization()
+{
+    if (!common::hasDirectSerialization(mDescriptor)) {
+        return;
+    }
+
+    //Fields are written in order of field numbers
+    std::vector<const FieldDescriptor *> fields;
+    for (int i = 0; i < mDescriptor->field_count(); i++) {
+        fields.push_back(mDescriptor->field(i));
+    }
+    std::sort(fields.begin(), fields.end(), [](const FieldDescriptor *a, const FieldDescriptor *b) {
+        return a->number() < b->number();
+    });
+
+    //Size is calculated before nested message is written, so its length is written before its data
+    mPrinter->Print(mTypeMap, Templates::DirectSerializedSizeBeginTemplate);
+    Indent();
+    for (const FieldDescriptor *field : fields) {
+        mPrinter->Print(common::producePropertyMap(field, mDescriptor),
+                        common::isPureMessage(field) ? Templates::DirectMessageFieldSizeTemplate
+                                                     : Templates::DirectFieldSizeTemplate);
+    }
+    mPrinter->Print(Templates::DirectSerializedSizeEndTemplate);
+    Outdent();
+    mPrinter->Print(Templates::SimpleBlockEnclosureTemplate);
+    mPrinter->Print("\n");
+
+    mPrinter->Print(mTypeMap, Templates::DirectSerializeToBeginTemplate);
+    Indent();
+    for (const FieldDescriptor *field : fields) {
+        mPrinter->Print(common::producePropertyMap(field, mDescriptor),
+                        common::isPureMessage(field) ? Templates::DirectWriteMessageFieldTemplate
+                                                     : Templates::DirectWriteFieldTemplate);
+    }
+    mPrinter->Print(Templates::DirectWriteUnknownFieldsTemplate);
+    Outdent();
+    mPrinter->Print(Templates::SimpleBlockEnclosureTemplate);
+    mPrinter->Print("\n");
+
+    const char *readMessageFieldTemplate = GeneratorOptions::instance().generateLazyParsing()
+            ? Templates::DirectReadLazyMessageFieldTemplate : Templates::DirectReadMessageFieldTemplate;
+    mPrinter->Print(mTypeMap, Templates::DirectParseFromBeginTemplate);
+    for (const FieldDescriptor *field : fields) {
+        mPrinter->Print(common::producePropertyMap(field, mDescriptor),
+                        common::isPureMessage(field) ? readMessageFieldTemplate
+                                                     : Templates::DirectReadFieldTemplate);
+    }
+    mPrinter->Print(Templates::DirectParseFromEndTemplate);
+}
+
 void MessageDefinitionPrinter::printDestructor()
 {
     mPrinter->Print(mTypeMap, Templates::RegistrarTemplate);
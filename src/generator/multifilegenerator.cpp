@@ -143,6 +143,9 @@ bool MultiFileGenerator::Generate(const FileDescriptor *file,
         if (GeneratorOptions::instance().hasQml()) {
             sourcePrinter->Print({{"include", "QQmlEngine"}}, Templates::ExternalIncludeTemplate);
         }
+        if (GeneratorOptions::instance().generateDirectSerialization()) {
+            sourcePrinter->Print({{"include", "QProtobufWireFormat"}}, Templates::ExternalIncludeTemplate);
+        }
 
         MessageDefinitionPrinter messageDef(message, sourcePrinter);
         messageDef.printClassDefinition();
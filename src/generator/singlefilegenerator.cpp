@@ -136,6 +136,9 @@ bool SingleFileGenerator::GenerateMessages(const ::google::protobuf::FileDescrip
     if (GeneratorOptions::instance().hasQml()) {
         sourcePrinter->Print({{"include", "QQmlEngine"}}, Templates::ExternalIncludeTemplate);
     }
+    if (GeneratorOptions::instance().generateDirectSerialization()) {
+        sourcePrinter->Print({{"include", "QProtobufWireFormat"}}, Templates::ExternalIncludeTemplate);
+    }
 
     printQtProtobufUsingNamespace(sourcePrinter);
 
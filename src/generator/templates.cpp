@@ -35,6 +35,7 @@ const char *Templates::DefaultProtobufIncludesTemplate = "#include <QMetaType>\n
                                                          "#include <QList>\n"
                                                          "#include <QProtobufObject>\n"
                                                          "#include <QProtobufLazyMessagePointer>\n"
+                                                         "#include <QProtobufLazyString>\n"
                                                          "#include <QSharedPointer>\n"
                                                          "\n"
                                                          "#include <memory>\n"
@@ -57,6 +58,46 @@ const char *Templates::GlobalEnumIncludeTemplate = "#include <globalenums.h>\n";
 
 const char *Templates::UsingQtProtobufNamespaceTemplate = "\nusing namespace QtProtobuf;\n";
 const char *Templates::ManualRegistrationDeclaration = "static void registerTypes();\n";
+const char *Templates::DirectSerializationDeclarationTemplate = "qsizetype serializedSize() const;\n"
+                                                                "void serializeTo(QByteArray &out) const;\n"
+                                                                "void parseFrom(QtProtobuf::QProtobufSelfcheckIterator &it);\n";
+const char *Templates::DirectSerializedSizeBeginTemplate = "qsizetype $classname$::serializedSize() const\n{\n"
+                                                         "    qsizetype size = 0;\n";
+const char *Templates::DirectFieldSizeTemplate = "size += QtProtobuf::QProtobufWireFormat::fieldSize($number$, m_$property_name$);\n";
+const char *Templates::DirectMessageFieldSizeTemplate = "size += QtProtobuf::QProtobufWireFormat::messageSize($number$, m_$property_name$);\n";
+const char *Templates::DirectSerializedSizeEndTemplate = "return size + m_unknownFields.size();\n";
+const char *Templates::DirectSerializeToBeginTemplate = "void $classname$::serializeTo(QByteArray &out) const\n{\n";
+const char *Templates::DirectWriteUnknownFieldsTemplate = "m_unknownFields.serializeTo(out);\n";
+const char *Templates::DirectWriteFieldTemplate = "QtProtobuf::QProtobufWireFormat::writeField($number$, m_$property_name$, out);\n";
+const char *Templates::DirectWriteMessageFieldTemplate = "QtProtobuf::QProtobufWireFormat::writeMessage($number$, m_$property_name$, out);\n";
+const char *Templates::DirectParseFromBeginTemplate = "void $classname$::parseFrom(QtProtobuf::QProtobufSelfcheckIterator &it)\n{\n"
+                                                      "    while (it.size() > 0) {\n"
+                                                      "        const char *fieldBegin = it.data();\n"
+                                                      "        int fieldNumber = 0;\n"
+                                                      "        QtProtobuf::WireTypes wireType = QtProtobuf::UnknownWireType;\n"
+                                                      "        QtProtobuf::QProtobufWireFormat::readHeader(it, fieldNumber, wireType);\n"
+                                                      "        switch (fieldNumber) {\n";
+const char *Templates::DirectReadFieldTemplate = "        case $number$:\n"
+                                                 "            if (!QtProtobuf::QProtobufWireFormat::readField(it, wireType, m_$property_name$)) {\n"
+                                                 "                QtProtobuf::QProtobufWireFormat::readUnknownField(it, fieldBegin, wireType, m_unknownFields);\n"
+                                                 "            }\n"
+                                                 "            break;\n";
+const char *Templates::DirectReadMessageFieldTemplate = "        case $number$:\n"
+                                                        "            if (!QtProtobuf::QProtobufWireFormat::readMessage(it, wireType, *m_$property_name$)) {\n"
+                                                        "                QtProtobuf::QProtobufWireFormat::readUnknownField(it, fieldBegin, wireType, m_unknownFields);\n"
+                                                        "            }\n"
+                                                        "            break;\n";
+const char *Templates::DirectReadLazyMessageFieldTemplate = "        case $number$:\n"
+                                                            "            if (!QtProtobuf::QProtobufWireFormat::readLazyMessage(it, wireType, m_$property_name$)) {\n"
+                                                            "                QtProtobuf::QProtobufWireFormat::readUnknownField(it, fieldBegin, wireType, m_unknownFields);\n"
+                                                            "            }\n"
+                                                            "            break;\n";
+const char *Templates::DirectParseFromEndTemplate = "        default:\n"
+                                                    "            QtProtobuf::QProtobufWireFormat::readUnknownField(it, fieldBegin, wireType, m_unknownFields);\n"
+                                                    "            break;\n"
+                                                    "        }\n"
+                                                    "    }\n"
+                                                    "}\n\n";
 const char *Templates::ManualRegistrationComplexTypeDefinition = "void $type$::registerTypes()\n{\n"
                                                                  "    qRegisterMetaType<$type$>(\"$full_type$\");\n"
                                                                  "    qRegisterMetaType<$type$*>(\"$full_type$*\");\n" //Somehow for aliastypes qRegisterMetaType logic doesn't work for pointer type registration
@@ -102,6 +143,7 @@ const char *Templates::ProtoConstructorEndTemplate = "QObject *parent = nullptr)
 const char *Templates::MemberTemplate = "$scope_type$ m_$property_name$;\n";
 const char *Templates::ListMemberTemplate = "$scope_list_type$ m_$property_name$;\n";
 const char *Templates::ComplexMemberTemplate = "QProtobufLazyMessagePointer<$scope_type$> m_$property_name$;\n";
+const char *Templates::LazyStringMemberTemplate = "QtProtobuf::QProtobufLazyString m_$property_name$;\n";
 const char *Templates::PublicBlockTemplate = "\npublic:\n";
 const char *Templates::PrivateBlockTemplate = "\nprivate:\n";
 const char *Templates::EnumDefinitionTemplate = "enum $type$ {\n";
@@ -118,22 +160,37 @@ const char *Templates::CopyConstructorDeclarationTemplate = "$classname$(const $
 const char *Templates::MoveConstructorDeclarationTemplate = "$classname$($classname$ &&other);\n";
 const char *Templates::CopyConstructorDefinitionTemplate = "$classname$::$classname$(const $classname$ &other) : QObject()";
 const char *Templates::MoveConstructorDefinitionTemplate = "$classname$::$classname$($classname$ &&other) : QObject()";
-const char *Templates::EmptyCopyConstructorDefinitionTemplate = "$classname$::$classname$(const $classname$ &) : QObject()";
-const char *Templates::EmptyMoveConstructorDefinitionTemplate = "$classname$::$classname$($classname$ &&) : QObject()";
 const char *Templates::DeletedCopyConstructorTemplate = "$classname$(const $classname$ &) = delete;\n";
 const char *Templates::DeletedMoveConstructorTemplate = "$classname$($classname$ &&) = delete;\n";
 const char *Templates::CopyFieldTemplate = "set$property_name_cap$(other.m_$property_name$);\n";
-const char *Templates::CopyComplexFieldTemplate = "if (m_$property_name$ != other.m_$property_name$) {\n"
+const char *Templates::CopyLazyStringFieldTemplate = "m_$property_name$ = other.m_$property_name$;\n";
+const char *Templates::AssignLazyStringFieldTemplate = "if (m_$property_name$ != other.m_$property_name$) {\n"
+                                                       "    m_$property_name$ = other.m_$property_name$;\n"
+                                                       "    $property_name$Changed();\n"
+                                                       "}\n";
+const char *Templates::CopyUnknownFieldsTemplate = "m_unknownFields = other.m_unknownFields;\n";
+const char *Templates::MoveUnknownFieldsTemplate = "m_unknownFields = std::move(other.m_unknownFields);\n";
+const char *Templates::CopyComplexFieldTemplate = "if (other.m_$property_name$.hasSerializedData()) {\n"
+                                                  "    m_$property_name$.copySerializedData(other.m_$property_name$);\n"
+                                                  "} else if (m_$property_name$ != other.m_$property_name$) {\n"
                                                   "    *m_$property_name$ = *other.m_$property_name$;\n"
                                                   "}\n";
-const char *Templates::AssignComplexFieldTemplate = "if (m_$property_name$ != other.m_$property_name$) {\n"
+const char *Templates::AssignComplexFieldTemplate = "if (other.m_$property_name$.hasSerializedData()) {\n"
+                                                    "    m_$property_name$.copySerializedData(other.m_$property_name$);\n"
+                                                    "    $property_name$Changed();\n"
+                                                    "} else if (m_$property_name$ != other.m_$property_name$) {\n"
                                                     "    *m_$property_name$ = *other.m_$property_name$;\n"
                                                     "    $property_name$Changed();\n"
                                                     "}\n";
-const char *Templates::MoveMessageFieldTemplate = "if (m_$property_name$ != other.m_$property_name$) {\n"
+const char *Templates::MoveMessageFieldTemplate = "if (other.m_$property_name$.hasSerializedData()) {\n"
+                                                  "    m_$property_name$.copySerializedData(other.m_$property_name$);\n"
+                                                  "} else if (m_$property_name$ != other.m_$property_name$) {\n"
                                                   "    *m_$property_name$ = std::move(*other.m_$property_name$);\n"
                                                   "}\n";
-const char *Templates::MoveAssignMessageFieldTemplate = "if (m_$property_name$ != other.m_$property_name$) {\n"
+const char *Templates::MoveAssignMessageFieldTemplate = "if (other.m_$property_name$.hasSerializedData()) {\n"
+                                                        "    m_$property_name$.copySerializedData(other.m_$property_name$);\n"
+                                                        "    $property_name$Changed();\n"
+                                                        "} else if (m_$property_name$ != other.m_$property_name$) {\n"
                                                         "    *m_$property_name$ = std::move(*other.m_$property_name$);\n"
                                                         "    $property_name$Changed();\n"
                                                         "    other.$property_name$Changed();\n"
@@ -153,12 +210,10 @@ const char *Templates::EnumMoveFieldTemplate = "m_$property_name$ = other.m_$pro
 
 const char *Templates::AssignmentOperatorDeclarationTemplate = "$classname$ &operator =(const $classname$ &other);\n";
 const char *Templates::AssignmentOperatorDefinitionTemplate = "$classname$ &$classname$::operator =(const $classname$ &other)\n{\n";
-const char *Templates::EmptyAssignmentOperatorDefinitionTemplate = "$classname$ &$classname$::operator =(const $classname$ &)\n{\n";
 const char *Templates::AssignmentOperatorReturnTemplate = "return *this;\n";
 
 const char *Templates::MoveAssignmentOperatorDeclarationTemplate = "$classname$ &operator =($classname$ &&other);\n";
 const char *Templates::MoveAssignmentOperatorDefinitionTemplate = "$classname$ &$classname$::operator =($classname$ &&other)\n{\n";
-const char *Templates::EmptyMoveAssignmentOperatorDefinitionTemplate = "$classname$ &$classname$::operator =($classname$ &&)\n{\n";
 
 const char *Templates::EqualOperatorDeclarationTemplate = "bool operator ==(const $classname$ &other) const;\n";
 const char *Templates::EqualOperatorDefinitionTemplate = "bool $classname$::operator ==(const $classname$ &other) const\n{\n"
@@ -243,7 +298,7 @@ const char *Templates::NonScriptableSetterTemplate = "void set$property_name_cap
 const char *Templates::SignalsBlockTemplate = "\nsignals:\n";
 const char *Templates::SignalTemplate = "void $property_name$Changed();\n";
 
-const char *Templates::FieldsOrderingContainerTemplate = "const QtProtobuf::QProtobufMetaObject $type$::protobufMetaObject = QtProtobuf::QProtobufMetaObject($type$::staticMetaObject, $type$::propertyOrdering);\n"
+const char *Templates::FieldsOrderingContainerTemplate = "const QtProtobuf::QProtobufMetaObject $type$::protobufMetaObject = QtProtobuf::QProtobufMetaObject($type$::staticMetaObject, $type$::propertyOrdering, QtProtobuf::unknownFieldsAccessor<$type$>);\n"
                                                          "const QtProtobuf::QProtobufPropertyOrdering $type$::propertyOrdering = {";
 const char *Templates::FieldOrderTemplate = "{$field_number$, {$property_number$, \"$json_name$\"}}";
 
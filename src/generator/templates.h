@@ -51,6 +51,20 @@ public:
     static const char *GlobalEnumIncludeTemplate;
     static const char *UsingQtProtobufNamespaceTemplate;
     static const char *ManualRegistrationDeclaration;
+    static const char *DirectSerializationDeclarationTemplate;
+    static const char *DirectSerializedSizeBeginTemplate;
+    static const char *DirectFieldSizeTemplate;
+    static const char *DirectMessageFieldSizeTemplate;
+    static const char *DirectSerializedSizeEndTemplate;
+    static const char *DirectSerializeToBeginTemplate;
+    static const char *DirectWriteUnknownFieldsTemplate;
+    static const char *DirectWriteFieldTemplate;
+    static const char *DirectWriteMessageFieldTemplate;
+    static const char *DirectParseFromBeginTemplate;
+    static const char *DirectReadFieldTemplate;
+    static const char *DirectReadMessageFieldTemplate;
+    static const char *DirectReadLazyMessageFieldTemplate;
+    static const char *DirectParseFromEndTemplate;
     static const char *ManualRegistrationComplexTypeDefinition;
     static const char *ManualRegistrationGlobalEnumDefinition;
     static const char *ComplexGlobalEnumFieldRegistrationTemplate;
@@ -92,6 +106,7 @@ public:
     static const char *MemberTemplate;
     static const char *ListMemberTemplate;
     static const char *ComplexMemberTemplate;
+    static const char *LazyStringMemberTemplate;
     static const char *PublicBlockTemplate;
     static const char *PrivateBlockTemplate;
     static const char *EnumDefinitionTemplate;
@@ -102,11 +117,13 @@ public:
     static const char *MoveConstructorDeclarationTemplate;
     static const char *CopyConstructorDefinitionTemplate;
     static const char *MoveConstructorDefinitionTemplate;
-    static const char *EmptyCopyConstructorDefinitionTemplate;
-    static const char *EmptyMoveConstructorDefinitionTemplate;
     static const char *DeletedCopyConstructorTemplate;
     static const char *DeletedMoveConstructorTemplate;
     static const char *CopyFieldTemplate;
+    static const char *CopyLazyStringFieldTemplate;
+    static const char *AssignLazyStringFieldTemplate;
+    static const char *CopyUnknownFieldsTemplate;
+    static const char *MoveUnknownFieldsTemplate;
     static const char *CopyComplexFieldTemplate;
     static const char *AssignComplexFieldTemplate;
     static const char *MoveMessageFieldTemplate;
@@ -117,11 +134,9 @@ public:
     static const char *EnumMoveFieldTemplate;
     static const char *AssignmentOperatorDeclarationTemplate;
     static const char *AssignmentOperatorDefinitionTemplate;
-    static const char *EmptyAssignmentOperatorDefinitionTemplate;
     static const char *AssignmentOperatorReturnTemplate;
     static const char *MoveAssignmentOperatorDeclarationTemplate;
     static const char *MoveAssignmentOperatorDefinitionTemplate;
-    static const char *EmptyMoveAssignmentOperatorDefinitionTemplate;
     static const char *EqualOperatorDeclarationTemplate;
     static const char *EqualOperatorDefinitionTemplate;
     static const char *EmptyEqualOperatorDefinitionTemplate;
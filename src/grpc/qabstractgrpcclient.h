@@ -185,7 +185,8 @@ protected:
         }
         return stream(method, argData, [ret, this](const QByteArray &data) {
             if (!ret.isNull()) {
-                tryDeserialize(*ret, data);
+                //Stream updates are deserialized to the same object, so it's updated in place
+                tryDeserialize(*ret, data, QtProtobuf::QAbstractProtobufSerializer::InPlaceDeserialization);
             } else {
                 static const QString nullPointerError(u"Pointer to return data is null while stream update received"_qs);
                 emit error({QGrpcStatus::InvalidArgument, nullPointerError});
@@ -220,12 +221,13 @@ private:
      * \brief Deserialization helper
      */
     template<typename R>
-    QGrpcStatus tryDeserialize(R &ret, const QByteArray &retData) {
+    QGrpcStatus tryDeserialize(R &ret, const QByteArray &retData,
+                               QtProtobuf::QAbstractProtobufSerializer::DeserializationMode mode = QtProtobuf::QAbstractProtobufSerializer::CopyDeserialization) {
         QGrpcStatus status{QGrpcStatus::Ok};
         auto _serializer = serializer();
         if (_serializer != nullptr) {
             try {
-                ret.deserialize(_serializer.get(), retData);
+                ret.deserialize(_serializer.get(), retData, mode);
             } catch (std::invalid_argument &) {
                 static const QString invalidArgumentErrorMessage(u"Response deserialization failed invalid field found"_qs);
                 status = {QGrpcStatus::InvalidArgument, invalidArgumentErrorMessage};
@@ -27,43 +27,83 @@
 #include <QVariant>
 #include <QMetaObject>
 #include <QMutex>
-#include <QSemaphore>
+
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+#include <vector>
 
 #include "qabstractprotobufserializer.h"
+#include "qprotobufmetaobject.h"
 
 using namespace QtProtobuf;
 
 namespace  {
 
-const int MaximumSimultaniousThreads = 64;
+//! \private Initial number of slots in handlers table, must be power of 2
+const std::size_t InitialHandlersTableCapacity = 64;
+
 /*!
  * \private
  * \brief The HandlersRegistry is container to store mapping between metatype identifier and serialization handlers.
+ *
+ * \details Handlers are stored in open addressing hash table that is only modified under write lock.
+ *          Lookup doesn't take any locks: slot key is published after slot handler, and table is
+ *          replaced by new one with larger capacity when it's half full. Handlers and replaced tables are
+ *          never deleted while registry exists, so lookup may proceed in replaced table and returned
+ *          handler references stay valid. Re-registered handler replaces pointer in slot atomically.
  */
 struct HandlersRegistry {
+    struct Slot {
+        std::atomic<int> userType{QMetaType::UnknownType};
+        std::atomic<const QtProtobufPrivate::SerializationHandler *> handler{nullptr};
+    };
 
-    HandlersRegistry() : m_readLock(MaximumSimultaniousThreads) {
+    struct Table {
+        explicit Table(std::size_t capacity) : mask(capacity - 1), slots(new Slot[capacity]) {}
+        const std::size_t mask;
+        std::unique_ptr<Slot[]> slots;
+    };
 
+    HandlersRegistry() {
+        m_tables.push_back(std::make_unique<Table>(InitialHandlersTableCapacity));
+        m_table.store(m_tables.back().get(), std::memory_order_release);
     }
 
     void registerHandler(int userType, const QtProtobufPrivate::SerializationHandler &handlers) {
+        Q_ASSERT_X(userType != QMetaType::UnknownType, "HandlersRegistry", "Invalid metatype identifier");
         QMutexLocker locker(&m_writeLock);
-        QSemaphoreReleaser releaser(m_readLock, MaximumSimultaniousThreads);
-        m_readLock.acquire(MaximumSimultaniousThreads);
-        m_registry[userType] = handlers;
+        m_handlers.push_back(std::make_unique<QtProtobufPrivate::SerializationHandler>(handlers));
+        const QtProtobufPrivate::SerializationHandler *handler = m_handlers.back().get();
+
+        Table *table = m_table.load(std::memory_order_relaxed);
+        Slot &existing = slot(table, userType);
+        if (existing.userType.load(std::memory_order_relaxed) == userType) {
+            existing.handler.store(handler, std::memory_order_release);
+            return;
+        }
+
+        if ((m_count + 1) * 2 > table->mask + 1) {
+            table = grow(table);
+        }
+        Slot &newSlot = slot(table, userType);
+        newSlot.handler.store(handler, std::memory_order_relaxed);
+        newSlot.userType.store(userType, std::memory_order_release);
+        ++m_count;
     }
 
-    QtProtobufPrivate::SerializationHandler findHandler(int userType) {
-        auto handler = empty;
-        QMutexLocker locker(&m_writeLock);
-        QSemaphoreReleaser releaser(m_readLock, 1);
-        m_readLock.acquire();
-        locker.unlock();
-        auto it = m_registry.find(userType);
-        if (it != m_registry.end()) {
-            handler = it->second;
+    const QtProtobufPrivate::SerializationHandler &findHandler(int userType) const {
+        const Table *table = m_table.load(std::memory_order_acquire);
+        for (std::size_t i = hash(userType) & table->mask;; i = (i + 1) & table->mask) {
+            const Slot &current = table->slots[i];
+            const int currentType = current.userType.load(std::memory_order_acquire);
+            if (currentType == userType) {
+                return *(current.handler.load(std::memory_order_acquire));
+            }
+            if (currentType == QMetaType::UnknownType) {
+                return empty;
+            }
         }
-        return handler;
     }
 
     static HandlersRegistry &instance() {
@@ -71,13 +111,45 @@ struct HandlersRegistry {
         return _instance;
     }
 private:
-    QSemaphore m_readLock;
+    static std::size_t hash(int userType) {
+        return static_cast<std::size_t>(static_cast<uint32_t>(userType) * 0x9e3779b1u);
+    }
+
+    //! Returns slot that holds \a userType or empty slot where \a userType should be inserted
+    static Slot &slot(Table *table, int userType) {
+        std::size_t i = hash(userType) & table->mask;
+        for (;; i = (i + 1) & table->mask) {
+            const int currentType = table->slots[i].userType.load(std::memory_order_relaxed);
+            if (currentType == userType || currentType == QMetaType::UnknownType) {
+                return table->slots[i];
+            }
+        }
+    }
+
+    Table *grow(Table *table) {
+        m_tables.push_back(std::make_unique<Table>((table->mask + 1) * 2));
+        Table *newTable = m_tables.back().get();
+        for (std::size_t i = 0; i <= table->mask; ++i) {
+            const int userType = table->slots[i].userType.load(std::memory_order_relaxed);
+            if (userType != QMetaType::UnknownType) {
+                Slot &newSlot = slot(newTable, userType);
+                newSlot.handler.store(table->slots[i].handler.load(std::memory_order_relaxed), std::memory_order_relaxed);
+                newSlot.userType.store(userType, std::memory_order_relaxed);
+            }
+        }
+        m_table.store(newTable, std::memory_order_release);
+        return newTable;
+    }
+
     QMutex m_writeLock;
-    std::unordered_map<int/*metatypeid*/, QtProtobufPrivate::SerializationHandler> m_registry;
-    static QtProtobufPrivate::SerializationHandler empty;
+    std::atomic<Table *> m_table{nullptr};
+    std::vector<std::unique_ptr<Table>> m_tables;
+    std::vector<std::unique_ptr<QtProtobufPrivate::SerializationHandler>> m_handlers;
+    std::size_t m_count = 0;
+    static const QtProtobufPrivate::SerializationHandler empty;
 };
 
-QtProtobufPrivate::SerializationHandler HandlersRegistry::empty{};
+const QtProtobufPrivate::SerializationHandler HandlersRegistry::empty{};
 }
 
 void QtProtobufPrivate::registerHandler(int userType, const QtProtobufPrivate::SerializationHandler &handlers)
@@ -85,7 +157,147 @@ void QtProtobufPrivate::registerHandler(int userType, const QtProtobufPrivate::S
     HandlersRegistry::instance().registerHandler(userType, handlers);
 }
 
-QtProtobufPrivate::SerializationHandler QtProtobufPrivate::findHandler(int userType)
+const QtProtobufPrivate::SerializationHandler &QtProtobufPrivate::findHandler(int userType)
 {
     return HandlersRegistry::instance().findHandler(userType);
 }
+
+QAbstractProtobufSerializer::NotificationBatch::NotificationBatch(QObject *object)
+{
+    collect(object);
+}
+
+int QAbstractProtobufSerializer::NotificationBatch::collect(QObject *object)
+{
+    //Nested object may be referred by few properties
+    auto it = m_stateIndices.constFind(object);
+    if (it != m_stateIndices.constEnd()) {
+        return it.value();
+    }
+
+    const int index = static_cast<int>(m_states.size());
+    m_stateIndices.insert(object, index);
+    m_states.push_back({object, object->blockSignals(true), {}, {}});
+
+    const QMetaObject *metaObject = object->metaObject();
+    for (int i = metaObject->propertyOffset(); i < metaObject->propertyCount(); ++i) {
+        const QMetaProperty property = metaObject->property(i);
+        QVariant value;
+        int nestedState = -1;
+        if (property.hasNotifySignal()) {
+            value = property.read(object);
+            if (value.metaType().flags() & QMetaType::PointerToQObject) {
+                QObject *nested = value.value<QObject *>();
+                if (nested != nullptr) {
+                    nestedState = collect(nested);
+                }
+            }
+        }
+        //m_states might be reallocated by collect call
+        m_states[index].values.append(value);
+        m_states[index].nestedStates.append(nestedState);
+    }
+    return index;
+}
+
+QAbstractProtobufSerializer::NotificationBatch::~NotificationBatch()
+{
+    for (const auto &state : m_states) {
+        if (!state.object.isNull()) {
+            state.object->blockSignals(state.signalsBlocked);
+        }
+    }
+
+    std::vector<bool> changed(m_states.size(), false);
+    //Nested objects are collected after objects that hold them, so walk backward to notify them first
+    for (int index = static_cast<int>(m_states.size()) - 1; index >= 0; --index) {
+        const ObjectState &state = m_states[index];
+        QObject *object = state.object.data();
+        if (object == nullptr) {
+            continue;
+        }
+
+        const QMetaObject *metaObject = object->metaObject();
+        QList<int> notifiedSignals;
+        for (int i = 0; i < state.values.size(); ++i) {
+            const QMetaProperty property = metaObject->property(metaObject->propertyOffset() + i);
+            if (!property.hasNotifySignal()) {
+                continue;
+            }
+            const int nestedState = state.nestedStates.at(i);
+            if ((nestedState < 0 || !changed[nestedState])
+                    && property.read(object) == state.values.at(i)) {
+                continue;
+            }
+            changed[index] = true;
+            //Few properties may share the same signal
+            const QMetaMethod signal = property.notifySignal();
+            if (notifiedSignals.contains(signal.methodIndex())) {
+                continue;
+            }
+            notifiedSignals.append(signal.methodIndex());
+            signal.invoke(object, Qt::DirectConnection);
+        }
+    }
+}
+
+QProtobufDecodeResult QAbstractProtobufSerializer::decodeMessage(MessageParser parser, QObject *object,
+                                                                 const QProtobufMetaObject &metaObject,
+                                                                 const QByteArray &data, bool notify)
+{
+    QProtobufDecodeResult result;
+    try {
+        parser(this, object, data, notify);
+        return result;
+    } catch (const std::out_of_range &) {
+        result.status = QProtobufDecodeResult::TruncatedData;
+    } catch (const std::invalid_argument &) {
+        result.status = QProtobufDecodeResult::DecodingFailed;
+    }
+
+    //Data is validated only after it failed to deserialize, to find the first error and its offset
+    const QProtobufDecodeResult validationResult = validateMessage(metaObject, data);
+    if (!validationResult.ok()) {
+        result = validationResult;
+    }
+    qProtoWarning() << metaObject.staticMetaObject.className() << "decoding failed with status" << result.status
+                    << "at offset" << result.offset;
+    return result;
+}
+
+void QAbstractProtobufSerializer::serializeMessage(const QObject *object, const QProtobufMetaObject &metaObject, QByteArray &out) const
+{
+    out.append(serializeMessage(object, metaObject));
+}
+
+bool QAbstractProtobufSerializer::serializeMessage(const QObject *object, const QProtobufMetaObject &metaObject, QIODevice *device) const
+{
+    Q_ASSERT_X(device != nullptr, "QAbstractProtobufSerializer", "Device is null");
+    const QByteArray data = serializeMessage(object, metaObject);
+    return device->write(data) == data.size();
+}
+
+void QAbstractProtobufSerializer::serializeObject(const QObject *object, const QProtobufMetaObject &metaObject, const QProtobufMetaProperty &metaProperty, QByteArray &out) const
+{
+    out.append(serializeObject(object, metaObject, metaProperty));
+}
+
+void QAbstractProtobufSerializer::serializeListObject(const QObject *object, const QProtobufMetaObject &metaObject, const QProtobufMetaProperty &metaProperty, QByteArray &out) const
+{
+    out.append(serializeListObject(object, metaObject, metaProperty));
+}
+
+void QAbstractProtobufSerializer::serializeMapPair(const QVariant &key, const QVariant &value, const QProtobufMetaProperty &metaProperty, QByteArray &out) const
+{
+    out.append(serializeMapPair(key, value, metaProperty));
+}
+
+void QAbstractProtobufSerializer::serializeEnum(int64 value, const QMetaEnum &metaEnum, const QProtobufMetaProperty &metaProperty, QByteArray &out) const
+{
+    out.append(serializeEnum(value, metaEnum, metaProperty));
+}
+
+void QAbstractProtobufSerializer::serializeEnumList(const QList<int64> &value, const QMetaEnum &metaEnum, const QProtobufMetaProperty &metaProperty, QByteArray &out) const
+{
+    out.append(serializeEnumList(value, metaEnum, metaProperty));
+}
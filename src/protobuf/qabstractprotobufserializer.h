@@ -28,17 +28,42 @@
 #include <QObject>
 #include <QVariant>
 #include <QMetaObject>
+#include <QIODevice>
+#include <QPointer>
+#include <QHash>
 
 #include <unordered_map>
 #include <functional>
 #include <memory>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 #include "qtprotobuftypes.h"
 #include "qtprotobuflogging.h"
 #include "qprotobufselfcheckiterator.h"
+#include "qprotobufdecoderesult.h"
+#include "qprotobufwireformat.h"
 
 #include "qtprotobufglobal.h"
 
+namespace QtProtobufPrivate {
+/*!
+ * \private
+ * \brief Detects if message type T provides serializeTo and parseFrom methods generated with
+ *        DIRECT_SERIALIZATION option
+ */
+template <typename T, typename = void>
+struct HasDirectSerialization : std::false_type {};
+
+template <typename T>
+struct HasDirectSerialization<T, std::void_t<decltype(std::declval<const T &>().serializeTo(std::declval<QByteArray &>())),
+                                             decltype(std::declval<T &>().parseFrom(std::declval<QtProtobuf::QProtobufSelfcheckIterator &>()))>>
+        : std::true_type {};
+}
+
 namespace QtProtobuf {
 
 class QProtobufMetaProperty;
@@ -71,6 +96,27 @@ class QProtobufMetaObject;
 class Q_PROTOBUF_EXPORT QAbstractProtobufSerializer
 {
 public:
+    /*!
+     * \brief The DeserializationMode enum defines how deserialized message is applied to the target object
+     */
+    enum DeserializationMode {
+        CopyDeserialization,    //!< Message is deserialized to temporary object, that is assigned to the target object
+        InPlaceDeserialization  //!< Target object is reset to default values and message is deserialized to it directly
+    };
+
+    /*!
+     * \brief The NotificationMode enum defines when change notifications of deserialized object are emitted
+     */
+    enum NotificationMode {
+        ImmediateNotifications, //!< Notify signals are emitted while message is deserialized
+        BatchedNotifications    //!< Signals of the object and its nested message objects are blocked while message
+                                //!< is deserialized. After that notify signal of every property that was changed is
+                                //!< emitted once, so bindings are re-evaluated when all fields are already updated.
+                                //!< Notify signal of message field property is emitted also if any field of nested
+                                //!< message was changed. Properties of the whole object tree are read before and
+                                //!< after deserialization, so lazily parsed nested messages are parsed.
+    };
+
     /*!
      * \brief Serialization of a registered qtproto message object into byte-array
      *
@@ -82,9 +128,63 @@ public:
     QByteArray serialize(const QObject *object) {
         Q_ASSERT(object != nullptr);
         qProtoDebug() << T::staticMetaObject.className() << "serialize";
+        if constexpr (QtProtobufPrivate::HasDirectSerialization<T>::value) {
+            if (supportsDirectWriting()) {
+                const T *message = static_cast<const T *>(object);
+                QtProtobuf::QProtobufWireFormat::SizeCache sizes;
+                QByteArray out;
+                out.reserve(message->serializedSize());
+                message->serializeTo(out);
+                return out;
+            }
+        }
         return serializeMessage(object, T::protobufMetaObject);
     }
 
+    /*!
+     * \brief Serialization of a registered qtproto message object appending result to \a out
+     *
+     * \details Existing content of \a out is preserved. It's possible to reuse the same buffer for
+     *          multiple messages to avoid memory reallocations.
+     *
+     * \param[in] object Pointer to QObject containing message to be serialized
+     * \param[out] out Buffer serialized message bytes are appended to
+     */
+    template<typename T>
+    void serialize(const QObject *object, QByteArray &out) {
+        Q_ASSERT(object != nullptr);
+        qProtoDebug() << T::staticMetaObject.className() << "serialize";
+        if constexpr (QtProtobufPrivate::HasDirectSerialization<T>::value) {
+            if (supportsDirectWriting()) {
+                const T *message = static_cast<const T *>(object);
+                QtProtobuf::QProtobufWireFormat::SizeCache sizes;
+                //Keep geometric growth when the same buffer is reused for multiple messages
+                const qsizetype required = out.size() + message->serializedSize();
+                if (required > out.capacity()) {
+                    out.reserve(qMax(required, out.capacity() * 2));
+                }
+                message->serializeTo(out);
+                return;
+            }
+        }
+        serializeMessage(object, T::protobufMetaObject, out);
+    }
+
+    /*!
+     * \brief Serialization of a registered qtproto message object into \a device
+     *
+     * \param[in] object Pointer to QObject containing message to be serialized
+     * \param[in] device Opened for writing device serialized message bytes are written to
+     * \result true if all serialized bytes were written to \a device
+     */
+    template<typename T>
+    bool serialize(const QObject *object, QIODevice *device) {
+        Q_ASSERT(object != nullptr);
+        Q_ASSERT(device != nullptr);
+        qProtoDebug() << T::staticMetaObject.className() << "serialize";
+        return serializeMessage(object, T::protobufMetaObject, device);
+    }
+
     /*!
      * \brief Deserialization of a byte-array into a registered qtproto message object
      *
@@ -96,22 +196,198 @@ public:
      */
     template<typename T>
     void deserialize(T *object, const QByteArray &data) {
+        deserialize(object, data, CopyDeserialization);
+    }
+
+    /*!
+     * \brief Deserialization of a byte-array into a registered qtproto message object, using \a mode
+     *
+     * \details In InPlaceDeserialization mode \a object is reset by moving default constructed message to it, and
+     *          data is deserialized to \a object directly, without copying of nested messages and lists. Change
+     *          signals are emitted only for properties that change, while fields are deserialized, or after
+     *          message is deserialized if generated direct deserialization is used, since it doesn't use
+     *          property setters. If deserialization fails, \a object keeps fields
+     *          that were deserialized before the failure, same as in CopyDeserialization mode, but in
+     *          CopyDeserialization mode \a object is changed by single assignment, after data is deserialized.
+     *
+     *          Change notifications are emitted according to \a notificationMode.
+     */
+    template<typename T>
+    void deserialize(T *object, const QByteArray &data, DeserializationMode mode,
+                     NotificationMode notificationMode = ImmediateNotifications) {
         Q_ASSERT(object != nullptr);
-        qProtoDebug() << T::staticMetaObject.className() << "deserialize";
-        //Initialize default object first and make copy aferwards, it's necessary to set default
-        //values of properties that was not stored in data.
-        T newValue;
-        try {
-            deserializeMessage(&newValue, T::protobufMetaObject, data);
-        } catch(...) {
+        std::optional<NotificationBatch> batch;
+        if (notificationMode == BatchedNotifications) {
+            batch.emplace(object);
+        }
+
+        if (mode == CopyDeserialization) {
+            qProtoDebug() << T::staticMetaObject.className() << "deserialize";
+            //Initialize default object first and make copy aferwards, it's necessary to set default
+            //values of properties that was not stored in data.
+            T newValue;
+            QT_TRY {
+                parseMessage(&newValue, data);
+            } QT_CATCH(...) {
+                *object = newValue;
+                QT_RETHROW;
+            }
             *object = newValue;
-            throw;
+            return;
         }
-        *object = newValue;
+
+        qProtoDebug() << T::staticMetaObject.className() << "deserialize in place";
+        *object = T();
+        parseMessage(object, data, notificationMode == ImmediateNotifications);
+    }
+
+    /*!
+     * \brief Deserialization of a byte-array into a registered qtproto message object, that reports errors without
+     *        exceptions
+     *
+     * \details \a data is deserialized once, using \a mode and \a notificationMode, and errors of the deserialization
+     *          are returned instead of thrown. Exceptions of the decoders don't leave the library, so this method
+     *          might be used in code that is built without exception support.
+     *
+     *          If \a data is malformed, status of the first error with its offset in \a data is returned. Offset is
+     *          found using validateMessage, that is called only for data that failed to deserialize. Errors of
+     *          serializers that don't validate data are reported as QProtobufDecodeResult::TruncatedData or
+     *          QProtobufDecodeResult::DecodingFailed with unknown offset. In CopyDeserialization mode \a object is
+     *          left unchanged if decoding fails, in InPlaceDeserialization mode it keeps fields that were
+     *          deserialized before the failure.
+     *
+     * \param[out] object Pointer to memory where result of deserialization should be injected
+     * \param[in] data Bytes with serialized message
+     * \param[in] mode Deserialization mode
+     * \param[in] notificationMode Notification mode
+     * \return Result of decoding
+     */
+    template<typename T>
+    QProtobufDecodeResult tryDeserialize(T *object, const QByteArray &data, DeserializationMode mode = CopyDeserialization,
+                                         NotificationMode notificationMode = ImmediateNotifications) {
+        Q_ASSERT(object != nullptr);
+        std::optional<NotificationBatch> batch;
+        if (notificationMode == BatchedNotifications) {
+            batch.emplace(object);
+        }
+
+        if (mode == CopyDeserialization) {
+            qProtoDebug() << T::staticMetaObject.className() << "try deserialize";
+            T newValue;
+            QProtobufDecodeResult result = decodeMessage(&parseMessageData<T>, &newValue, T::protobufMetaObject,
+                                                         data, false);
+            if (result.ok()) {
+                *object = newValue;
+            }
+            return result;
+        }
+
+        qProtoDebug() << T::staticMetaObject.className() << "try deserialize in place";
+        *object = T();
+        return decodeMessage(&parseMessageData<T>, object, T::protobufMetaObject, data,
+                             notificationMode == ImmediateNotifications);
     }
 
     virtual ~QAbstractProtobufSerializer() = default;
 
+private:
+    /*!
+     * \private
+     * \brief The NotificationBatch class blocks signals of the object and its nested objects while exists
+     *
+     * \details Values of the properties are stored when batch is created. On destruction, signals are unblocked
+     *          and notify signals of properties that values differ from stored values are emitted once.
+     *          Nested objects are notified before objects that hold them.
+     */
+    class Q_PROTOBUF_EXPORT NotificationBatch final
+    {
+    public:
+        explicit NotificationBatch(QObject *object);
+        ~NotificationBatch();
+
+    private:
+        Q_DISABLE_COPY_MOVE(NotificationBatch)
+        int collect(QObject *object);
+
+        struct ObjectState {
+            QPointer<QObject> object;
+            bool signalsBlocked;
+            QList<QVariant> values;
+            QList<int> nestedStates;
+        };
+        std::vector<ObjectState> m_states;
+        QHash<const QObject *, int> m_stateIndices;
+    };
+
+    template<typename T>
+    void parseMessage(T *object, const QByteArray &data, bool notify = false) {
+        if constexpr (QtProtobufPrivate::HasDirectSerialization<T>::value) {
+            if (supportsDirectSerialization()) {
+                QProtobufSelfcheckIterator it(data);
+                //Generated parseFrom doesn't use setters, so changes are notified by batch
+                std::optional<NotificationBatch> batch;
+                if (notify) {
+                    batch.emplace(object);
+                }
+                object->parseFrom(it);
+                return;
+            }
+        }
+        deserializeMessage(object, T::protobufMetaObject, data);
+    }
+
+    //! \private
+    using MessageParser = void (*)(QAbstractProtobufSerializer *serializer, QObject *object, const QByteArray &data,
+                                   bool notify);
+
+    //! \private
+    template<typename T>
+    static void parseMessageData(QAbstractProtobufSerializer *serializer, QObject *object, const QByteArray &data,
+                                 bool notify) {
+        serializer->parseMessage(static_cast<T *>(object), data, notify);
+    }
+
+    /*!
+     * \private
+     * \brief Deserializes \a data to \a object using \a parser and returns errors of the decoders as result
+     */
+    QProtobufDecodeResult decodeMessage(MessageParser parser, QObject *object, const QProtobufMetaObject &metaObject,
+                                        const QByteArray &data, bool notify);
+
+public:
+
+    /*!
+     * \brief Returns true if serializer produces protobuf binary wire format
+     *
+     * \details If true, messages generated with DIRECT_SERIALIZATION option are serialized and deserialized using
+     *          their generated serializeTo and parseFrom methods instead of the serializer methods.
+     */
+    virtual bool supportsDirectSerialization() const { return false; }
+
+    /*!
+     * \brief Returns true if messages generated with DIRECT_SERIALIZATION option might be serialized using their
+     *        generated serializeTo method
+     *
+     * \details Generated serializeTo methods don't write fields that hold proto3 default values, serializers that
+     *          are configured to write them use serializeMessage instead. Default implementation returns
+     *          supportsDirectSerialization().
+     */
+    virtual bool supportsDirectWriting() const { return supportsDirectSerialization(); }
+
+    /*!
+     * \brief Checks that \a data is well-formed message of type described by \a metaObject, without deserializing it
+     *
+     * \details Must not throw on malformed data. Default implementation accepts any data, so errors are reported
+     *          by deserialization only.
+     *
+     * \see tryDeserialize
+     */
+    virtual QProtobufDecodeResult validateMessage(const QProtobufMetaObject &metaObject, const QByteArray &data) const {
+        Q_UNUSED(metaObject)
+        Q_UNUSED(data)
+        return {};
+    }
+
     /*!
      * \brief serializeMessage
      * \param object
@@ -121,6 +397,25 @@ public:
      */
     virtual QByteArray serializeMessage(const QObject *object, const QProtobufMetaObject &metaObject) const = 0;
 
+    /*!
+     * \brief serializeMessage Serializes \a object and appends result to \a out
+     * \details Default implementation appends result of serializeMessage(object, metaObject)
+     * \param[in] object Pointer to object to be serialized
+     * \param[in] metaObject Protobuf meta object information for given \a object
+     * \param[out] out Buffer serialized data is appended to
+     */
+    virtual void serializeMessage(const QObject *object, const QProtobufMetaObject &metaObject, QByteArray &out) const;
+
+    /*!
+     * \brief serializeMessage Serializes \a object and writes result to \a device
+     * \details Default implementation writes result of serializeMessage(object, metaObject)
+     * \param[in] object Pointer to object to be serialized
+     * \param[in] metaObject Protobuf meta object information for given \a object
+     * \param[in] device Device serialized data is written to
+     * \return true if all serialized data was written to \a device
+     */
+    virtual bool serializeMessage(const QObject *object, const QProtobufMetaObject &metaObject, QIODevice *device) const;
+
     /*!
      * \brief serializeMessage
      * \param object
@@ -140,6 +435,13 @@ public:
      */
     virtual QByteArray serializeObject(const QObject *object, const QProtobufMetaObject &metaObject, const QProtobufMetaProperty &metaProperty) const = 0;
 
+    /*!
+     * \brief serializeObject Serializes \a object and appends result to \a out
+     * \details Default implementation appends result of serializeObject(object, metaObject, metaProperty)
+     * \param[out] out Buffer serialized data is appended to
+     */
+    virtual void serializeObject(const QObject *object, const QProtobufMetaObject &metaObject, const QProtobufMetaProperty &metaProperty, QByteArray &out) const;
+
     /*!
      * \brief deserializeObject Deserializes buffer to an \a object
      * \param[out] object Pointer to pre-allocated object
@@ -170,6 +472,13 @@ public:
      */
     virtual QByteArray serializeListObject(const QObject *object, const QProtobufMetaObject &metaObject, const QProtobufMetaProperty &metaProperty) const = 0;
 
+    /*!
+     * \brief serializeListObject Serializes \a object as a part of list property and appends result to \a out
+     * \details Default implementation appends result of serializeListObject(object, metaObject, metaProperty)
+     * \param[out] out Buffer serialized data is appended to
+     */
+    virtual void serializeListObject(const QObject *object, const QProtobufMetaObject &metaObject, const QProtobufMetaProperty &metaProperty, QByteArray &out) const;
+
     /*!
      * \brief serializeListEnd Method called at the end of object list serialization
      * \param[in] buffer Buffer at and of list serialization
@@ -212,6 +521,13 @@ public:
      */
     virtual QByteArray serializeMapPair(const QVariant &key, const QVariant &value, const QProtobufMetaProperty &metaProperty) const = 0;
 
+    /*!
+     * \brief serializeMapPair Serializes QMap pair of \a key and \a value and appends result to \a out
+     * \details Default implementation appends result of serializeMapPair(key, value, metaProperty)
+     * \param[out] out Buffer serialized data is appended to
+     */
+    virtual void serializeMapPair(const QVariant &key, const QVariant &value, const QProtobufMetaProperty &metaProperty, QByteArray &out) const;
+
     /*!
      * \brief serializeMapEnd Method called at the end of map serialization
      * \param[in] buffer Buffer at and of list serialization
@@ -246,6 +562,13 @@ public:
      */
     virtual QByteArray serializeEnum(int64 value, const QMetaEnum &metaEnum, const QtProtobuf::QProtobufMetaProperty &metaProperty) const = 0;
 
+    /*!
+     * \brief serializeEnum Serializes enum value represented as int64 type and appends result to \a out
+     * \details Default implementation appends result of serializeEnum(value, metaEnum, metaProperty)
+     * \param[out] out Buffer serialized data is appended to
+     */
+    virtual void serializeEnum(int64 value, const QMetaEnum &metaEnum, const QtProtobuf::QProtobufMetaProperty &metaProperty, QByteArray &out) const;
+
     /*!
      * \brief serializeEnumList  Method called to serialize list of enum values
      * \param[in] value List of enum values to be serialized, represented as int64
@@ -257,6 +580,13 @@ public:
      */
     virtual QByteArray serializeEnumList(const QList<int64> &value, const QMetaEnum &metaEnum, const QtProtobuf::QProtobufMetaProperty &metaProperty) const = 0;
 
+    /*!
+     * \brief serializeEnumList Serializes list of enum values and appends result to \a out
+     * \details Default implementation appends result of serializeEnumList(value, metaEnum, metaProperty)
+     * \param[out] out Buffer serialized data is appended to
+     */
+    virtual void serializeEnumList(const QList<int64> &value, const QMetaEnum &metaEnum, const QtProtobuf::QProtobufMetaProperty &metaProperty, QByteArray &out) const;
+
     /*!
      * \brief deserializeEnum Deserializes enum value from byte stream
      * \param[out] value Buffer that will be used to collect new enum value
@@ -287,9 +617,9 @@ template<typename T>
 static void qRegisterProtobufType() {
     T::registerTypes();
     QtProtobufPrivate::registerHandler(qMetaTypeId<T *>(), { QtProtobufPrivate::serializeObject<T>,
-            QtProtobufPrivate::deserializeObject<T>, QtProtobufPrivate::ObjectHandler });
+            QtProtobufPrivate::deserializeObject<T>, QtProtobufPrivate::ObjectHandler, &T::protobufMetaObject });
     QtProtobufPrivate::registerHandler(qMetaTypeId<QList<QSharedPointer<T>>>(), { QtProtobufPrivate::serializeList<T>,
-            QtProtobufPrivate::deserializeList<T>, QtProtobufPrivate::ListHandler });
+            QtProtobufPrivate::deserializeList<T>, QtProtobufPrivate::ListHandler, &T::protobufMetaObject });
 }
 
 /*!
@@ -314,7 +644,7 @@ template<typename K, typename V,
          typename std::enable_if_t<std::is_base_of<QObject, V>::value, int> = 0>
 inline void qRegisterProtobufMapType() {
     QtProtobufPrivate::registerHandler(qMetaTypeId<QMap<K, QSharedPointer<V>>>(), { QtProtobufPrivate::serializeMap<K, V>,
-    QtProtobufPrivate::deserializeMap<K, V>, QtProtobufPrivate::MapHandler });
+    QtProtobufPrivate::deserializeMap<K, V>, QtProtobufPrivate::MapHandler, &V::protobufMetaObject });
 }
 
 
@@ -40,6 +40,7 @@ namespace QtProtobuf {
     class QAbstractProtobufSerializer;
     class QProtobufSelfcheckIterator;
     class QProtobufMetaProperty;
+    class QProtobufMetaObject;
 }
 
 namespace QtProtobufPrivate {
@@ -66,9 +67,32 @@ struct SerializationHandler {
     Serializer serializer; /*!< serializer assigned to class */
     Deserializer deserializer;/*!< deserializer assigned to class */
     HandlerType type;/*!< Serialization WireType */
+    const QtProtobuf::QProtobufMetaObject *metaObject = nullptr;/*!< Message type metaobject of object, list element or map value */
 };
 
-extern Q_PROTOBUF_EXPORT SerializationHandler findHandler(int userType);
+/*!
+ * \private
+ * \brief Returns reference to the container of type T stored in \a variant
+ *
+ * \details Converts \a variant to T if it holds value of different type. Returned reference allows to append
+ *          elements to the container in place, without copying whole container on every element.
+ */
+template <typename T>
+T &variantContainer(QVariant &variant) {
+    if (variant.userType() != qMetaTypeId<T>()) {
+        variant = QVariant::fromValue<T>(variant.value<T>());
+    }
+    return *static_cast<T *>(variant.data());
+}
+
+/*!
+ * \private
+ * \brief Returns handler registered for \a userType or empty handler if no handler is registered
+ *
+ * \details Lookup is lock-free. Returned reference stays valid until the end of program, even if handler
+ *          is re-registered.
+ */
+extern Q_PROTOBUF_EXPORT const SerializationHandler &findHandler(int userType);
 extern Q_PROTOBUF_EXPORT void registerHandler(int userType, const SerializationHandler &handlers);
 
 /*!
@@ -79,7 +103,7 @@ template <typename T,
           typename std::enable_if_t<std::is_base_of<QObject, T>::value, int> = 0>
 void serializeObject(const QtProtobuf::QAbstractProtobufSerializer *serializer, const QVariant &value, const QtProtobuf::QProtobufMetaProperty &metaProperty, QByteArray &buffer) {
     Q_ASSERT_X(serializer != nullptr, "QAbstractProtobufSerializer", "Serializer is null");
-    buffer.append(serializer->serializeObject(value.value<T *>(), T::protobufMetaObject, metaProperty));
+    serializer->serializeObject(value.value<T *>(), T::protobufMetaObject, metaProperty, buffer);
 }
 
 /*!
@@ -100,7 +124,7 @@ void serializeList(const QtProtobuf::QAbstractProtobufSerializer *serializer, co
             qProtoWarning() << "Null pointer in list";
             continue;
         }
-        buffer.append(serializer->serializeListObject(value.data(), V::protobufMetaObject, metaProperty));
+        serializer->serializeListObject(value.data(), V::protobufMetaObject, metaProperty, buffer);
     }
     buffer.append(serializer->serializeListEnd(buffer, metaProperty));
 }
@@ -116,7 +140,7 @@ void serializeMap(const QtProtobuf::QAbstractProtobufSerializer *serializer, con
     QMap<K,V> mapValue = value.value<QMap<K,V>>();
     buffer.append(serializer->serializeMapBegin(metaProperty));
     for (auto it = mapValue.constBegin(); it != mapValue.constEnd(); it++) {
-        buffer.append(serializer->serializeMapPair(QVariant::fromValue<K>(it.key()), QVariant::fromValue<V>(it.value()), metaProperty));
+        serializer->serializeMapPair(QVariant::fromValue<K>(it.key()), QVariant::fromValue<V>(it.value()), metaProperty, buffer);
     }
     buffer.append(serializer->serializeMapEnd(buffer, metaProperty));
 }
@@ -136,7 +160,7 @@ void serializeMap(const QtProtobuf::QAbstractProtobufSerializer *serializer, con
             qProtoWarning() << __func__ << "Trying to serialize map value that contains nullptr";
             continue;
         }
-        buffer.append(serializer->serializeMapPair(QVariant::fromValue<K>(it.key()), QVariant::fromValue<V *>(it.value().data()), metaProperty));
+        serializer->serializeMapPair(QVariant::fromValue<K>(it.key()), QVariant::fromValue<V *>(it.value().data()), metaProperty, buffer);
     }
     buffer.append(serializer->serializeMapEnd(buffer, metaProperty));
 }
@@ -149,7 +173,7 @@ template<typename T,
          typename std::enable_if_t<std::is_enum<T>::value, int> = 0>
 void serializeEnum(const QtProtobuf::QAbstractProtobufSerializer *serializer, const QVariant &value, const QtProtobuf::QProtobufMetaProperty &metaProperty, QByteArray &buffer) {
     Q_ASSERT_X(serializer != nullptr, "QAbstractProtobufSerializer", "Serializer is null");
-    buffer.append(serializer->serializeEnum(QtProtobuf::int64(value.value<T>()), QMetaEnum::fromType<T>(),  metaProperty));
+    serializer->serializeEnum(QtProtobuf::int64(value.value<T>()), QMetaEnum::fromType<T>(), metaProperty, buffer);
 }
 
 /*!
@@ -164,7 +188,7 @@ void serializeEnumList(const QtProtobuf::QAbstractProtobufSerializer *serializer
     for (auto enumValue : value.value<QList<T>>()) {
         intList.append(QtProtobuf::int64(enumValue));
     }
-    buffer.append(serializer->serializeEnumList(intList, QMetaEnum::fromType<T>(), metaProperty));
+    serializer->serializeEnumList(intList, QMetaEnum::fromType<T>(), metaProperty, buffer);
 }
 
 /*!
@@ -191,10 +215,8 @@ void deserializeList(const QtProtobuf::QAbstractProtobufSerializer *serializer,
     qProtoDebug() << __func__ << "currentByte:" << QString::number((*it), 16);
 
     V *newValue = new V;
-    QList<QSharedPointer<V>> list = previous.value<QList<QSharedPointer<V>>>();
     if (serializer->deserializeListObject(newValue, V::protobufMetaObject, it)) {
-        list.append(QSharedPointer<V>(newValue));
-        previous.setValue(list);
+        variantContainer<QList<QSharedPointer<V>>>(previous).append(QSharedPointer<V>(newValue));
     }
 }
 
@@ -209,13 +231,11 @@ void deserializeMap(const QtProtobuf::QAbstractProtobufSerializer *serializer, Q
     Q_ASSERT_X(serializer != nullptr, "QAbstractProtobufSerializer", "Serializer is null");
     qProtoDebug() << __func__ << "currentByte:" << QString::number((*it), 16);
 
-    QMap<K, V> out = previous.value<QMap<K, V>>();
     QVariant key = QVariant::fromValue<K>(K());
     QVariant value = QVariant::fromValue<V>(V());
 
     if (serializer->deserializeMapPair(key, value, it)) {
-        out[key.value<K>()] = value.value<V>();
-        previous = QVariant::fromValue<QMap<K, V>>(out);
+        variantContainer<QMap<K, V>>(previous)[key.value<K>()] = value.value<V>();
     }
 }
 
@@ -231,13 +251,11 @@ void deserializeMap(const QtProtobuf::QAbstractProtobufSerializer *serializer, Q
     Q_ASSERT_X(serializer != nullptr, "QAbstractProtobufSerializer", "Serializer is null");
     qProtoDebug() << __func__ << "currentByte:" << QString::number((*it), 16);
 
-    auto out = previous.value<QMap<K, QSharedPointer<V>>>();
     QVariant key = QVariant::fromValue<K>(K());
     QVariant value = QVariant::fromValue<V *>(nullptr);
 
     if (serializer->deserializeMapPair(key, value, it)) {
-        out[key.value<K>()] = QSharedPointer<V>(value.value<V *>());
-        previous = QVariant::fromValue<QMap<K, QSharedPointer<V>>>(out);
+        variantContainer<QMap<K, QSharedPointer<V>>>(previous)[key.value<K>()] = QSharedPointer<V>(value.value<V *>());
     }
 }
 
@@ -0,0 +1,72 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+
+#pragma once //QProtobufDecodeResult
+
+#include <QtGlobal>
+
+#include "qtprotobufglobal.h"
+
+namespace QtProtobuf {
+
+/*!
+ * \ingroup QtProtobuf
+ * \brief The QProtobufDecodeResult class holds result of message decoding, that is reported without exceptions
+ *
+ * \details Returned by QAbstractProtobufSerializer::tryDeserialize. If decoding failed, status holds the kind of
+ *          the first error found in data and offset holds position of the malformed field header in data.
+ *          Errors found in nested messages are reported with offset of the field in nested message.
+ *
+ * \see QAbstractProtobufSerializer::tryDeserialize
+ */
+struct QProtobufDecodeResult
+{
+    /*!
+     * \brief The Status enum defines kind of decoding error
+     */
+    enum Status {
+        NoError,            //!< Data is decoded successfully
+        TruncatedData,      //!< Data ends before field header, value or length-delimited payload is complete
+        MalformedVarint,    //!< Varint is longer than 10 bytes
+        InvalidFieldNumber, //!< Field number is 0 or greater than 2^29 - 1
+        InvalidWireType,    //!< Wire type is not one of Varint, Fixed64, LengthDelimited or Fixed32
+        WireTypeMismatch,   //!< Wire type of known field doesn't match type of the field
+        InvalidPackedField, //!< Payload of packed repeated field is not a sequence of complete elements
+        NestingTooDeep,     //!< Nesting of messages exceeds QProtobufDecodeResult::MaxNestingDepth
+        DecodingFailed      //!< Data was rejected while message was deserialized, offset is unknown
+    };
+
+    //! Maximum nesting depth of messages, that is accepted while data is validated
+    static constexpr int MaxNestingDepth = 100;
+
+    Status status = NoError; //!< Kind of the first error found in data
+    qsizetype offset = -1; //!< Offset of malformed field in data, or -1 if it's unknown
+
+    /*!
+     * \brief Returns true if data was decoded successfully
+     */
+    bool ok() const { return status == NoError; }
+};
+
+}
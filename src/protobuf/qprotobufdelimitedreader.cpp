@@ -0,0 +1,108 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+
+#include "qprotobufdelimitedreader.h"
+#include "qprotobufserializer_p.h"
+#include "qprotobufpackedcodec_p.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+using namespace QtProtobuf;
+
+QProtobufDelimitedReader::QProtobufDelimitedReader(QIODevice *device, qsizetype bufferSize) : m_device(device)
+  , m_bufferSize(std::max(bufferSize, qsizetype(16)))
+{
+    Q_ASSERT(m_device != nullptr);
+}
+
+bool QProtobufDelimitedReader::readRecord(QByteArray &record)
+{
+    uint64_t size = 0;
+    const char *begin = m_buffer.constData() + m_offset;
+    const char *next = QProtobufPackedCodec::tryReadVarint(begin, m_buffer.constData() + m_buffer.size(), size);
+    if (next == nullptr) {
+        if (!fill(m_buffer.size() - m_offset + 1)) {
+            if (m_offset == m_buffer.size()) {
+                return false;
+            }
+            throw std::out_of_range("Data ends in the middle of record size. Deserialization failed");
+        }
+        return readRecord(record);
+    }
+
+    if (size > static_cast<uint64_t>(std::numeric_limits<int>::max())) {
+        throw std::out_of_range("Record size exceeds maximum size of container. Deserialization failed");
+    }
+
+    const qsizetype recordOffset = m_offset + (next - begin);
+    const qsizetype recordEnd = recordOffset + static_cast<qsizetype>(size);
+    if (recordEnd > m_buffer.size()) {
+        if (!fill(recordEnd - m_offset)) {
+            throw std::out_of_range("Data ends in the middle of record. Deserialization failed");
+        }
+        return readRecord(record);
+    }
+
+    record = QProtobufSerializerPrivate::sharedData(&m_buffer, m_buffer.constData() + recordOffset,
+                                                    static_cast<int>(size));
+    m_offset = recordEnd;
+    return true;
+}
+
+bool QProtobufDelimitedReader::atEnd() const
+{
+    return m_offset == m_buffer.size() && m_device->atEnd();
+}
+
+/*
+ * Reads device data, until buffer contains at least required bytes after current offset.
+ * Returns false if device has no more data.
+ */
+bool QProtobufDelimitedReader::fill(qsizetype required)
+{
+    //New buffer is allocated, because records that were read before may share the old one
+    const qsizetype tail = m_buffer.size() - m_offset;
+    QByteArray buffer(std::max(m_bufferSize, required), Qt::Uninitialized);
+    memcpy(buffer.data(), m_buffer.constData() + m_offset, static_cast<size_t>(tail));
+
+    qsizetype size = tail;
+    while (size < required) {
+        const qint64 bytesRead = m_device->read(buffer.data() + size, buffer.size() - size);
+        if (bytesRead <= 0) {
+            break;
+        }
+        size += bytesRead;
+    }
+
+    const bool filled = size >= required;
+    if (size > tail || filled) {
+        buffer.resize(size);
+        m_buffer = buffer;
+        m_offset = 0;
+    }
+    return filled;
+}
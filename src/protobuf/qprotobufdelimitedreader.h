@@ -0,0 +1,114 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+
+#pragma once //QProtobufDelimitedReader
+
+#include <QByteArray>
+#include <QIODevice>
+#include <QList>
+#include <QSharedPointer>
+
+#include "qtprotobufglobal.h"
+#include "qprotobufserializer.h"
+
+namespace QtProtobuf {
+
+/*!
+ * \ingroup QtProtobuf
+ * \brief The QProtobufDelimitedReader class reads sequence of messages, each prefixed with its varint encoded size,
+ *        from QIODevice
+ *
+ * \details Framing is compatible with writeDelimitedTo and parseDelimitedFrom functions of protobuf library.
+ *          Device is read by blocks of buffer size, so multiple messages are decoded per device read. Records
+ *          share memory with the read buffer and are not copied before deserialization.
+ *
+ *          Functions throw std::out_of_range if data ends in the middle of record, and std::invalid_argument if
+ *          record size is malformed.
+ *
+ * \see QProtobufDelimitedWriter
+ */
+class Q_PROTOBUF_EXPORT QProtobufDelimitedReader final
+{
+public:
+    static constexpr qsizetype DefaultBufferSize = 65536;
+
+    /*!
+     * \brief Constructs reader for \a device opened for reading
+     */
+    explicit QProtobufDelimitedReader(QIODevice *device, qsizetype bufferSize = DefaultBufferSize);
+
+    /*!
+     * \brief Reads next record and deserializes it to registered qtproto \a message
+     * \return false if there are no more records
+     */
+    template<typename T>
+    bool read(T *message) {
+        QByteArray record;
+        if (!readRecord(record)) {
+            return false;
+        }
+        m_serializer.deserialize<T>(message, record);
+        return true;
+    }
+
+    /*!
+     * \brief Reads up to \a maxCount records and appends deserialized messages to \a messages
+     * \return Number of messages that were read
+     */
+    template<typename T>
+    qsizetype readBatch(QList<QSharedPointer<T>> &messages, qsizetype maxCount) {
+        qsizetype count = 0;
+        QByteArray record;
+        while (count < maxCount && readRecord(record)) {
+            QSharedPointer<T> message = QSharedPointer<T>::create();
+            m_serializer.deserialize<T>(message.data(), record);
+            messages.append(message);
+            ++count;
+        }
+        return count;
+    }
+
+    /*!
+     * \brief Reads next serialized message to \a record
+     * \return false if there are no more records
+     */
+    bool readRecord(QByteArray &record);
+
+    /*!
+     * \brief Returns true if all records were read and device has no more data
+     */
+    bool atEnd() const;
+
+private:
+    bool fill(qsizetype required);
+
+    Q_DISABLE_COPY_MOVE(QProtobufDelimitedReader)
+    QIODevice *m_device;
+    const qsizetype m_bufferSize;
+    QByteArray m_buffer;
+    qsizetype m_offset = 0;
+    QProtobufSerializer m_serializer;
+};
+
+}
@@ -0,0 +1,78 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+
+#include "qprotobufdelimitedwriter.h"
+#include "qprotobufserializer_p.h"
+
+using namespace QtProtobuf;
+
+QProtobufDelimitedWriter::QProtobufDelimitedWriter(QIODevice *device, qsizetype bufferSize) : m_device(device)
+  , m_bufferSize(bufferSize)
+{
+    Q_ASSERT(m_device != nullptr);
+    m_buffer.reserve(m_bufferSize);
+}
+
+QProtobufDelimitedWriter::~QProtobufDelimitedWriter()
+{
+    if (!flush()) {
+        qProtoWarning() << "Unable to write" << m_buffer.size() << "bytes of buffered messages";
+    }
+}
+
+bool QProtobufDelimitedWriter::writeRecord(const QByteArray &data)
+{
+    QProtobufSerializerPrivate::writeLengthDelimited(data, m_buffer);
+    return flushIfFull();
+}
+
+void QProtobufDelimitedWriter::writeMessage(const QObject *message, const QProtobufMetaObject &metaObject)
+{
+    m_serializer.dPtr->serializeMessage(message, metaObject, m_buffer, true);
+}
+
+bool QProtobufDelimitedWriter::flush()
+{
+    if (m_buffer.isEmpty()) {
+        return true;
+    }
+    const qint64 written = m_device->write(m_buffer);
+    if (written != m_buffer.size()) {
+        if (written > 0) {
+            m_buffer.remove(0, written);
+        }
+        return false;
+    }
+    //Size is reset, but allocated memory is kept for next messages
+    m_buffer.resize(0);
+    return true;
+}
+
+bool QProtobufDelimitedWriter::flushIfFull()
+{
+    if (m_buffer.size() < m_bufferSize) {
+        return true;
+    }
+    return flush();
+}
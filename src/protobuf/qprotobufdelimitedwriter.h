@@ -0,0 +1,100 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+
+#pragma once //QProtobufDelimitedWriter
+
+#include <QByteArray>
+#include <QIODevice>
+
+#include "qtprotobufglobal.h"
+#include "qprotobufserializer.h"
+#include "qprotobufwireformat.h"
+
+namespace QtProtobuf {
+
+/*!
+ * \ingroup QtProtobuf
+ * \brief The QProtobufDelimitedWriter class writes sequence of messages to QIODevice, each message prefixed with
+ *        its varint encoded size
+ *
+ * \details Framing is compatible with writeDelimitedTo and parseDelimitedFrom functions of protobuf library.
+ *          Messages are serialized to internal buffer, that is written to the device when it exceeds buffer size,
+ *          when flush() is called and when writer is destroyed.
+ *
+ * \see QProtobufDelimitedReader
+ */
+class Q_PROTOBUF_EXPORT QProtobufDelimitedWriter final
+{
+public:
+    static constexpr qsizetype DefaultBufferSize = 65536;
+
+    /*!
+     * \brief Constructs writer for \a device opened for writing
+     */
+    explicit QProtobufDelimitedWriter(QIODevice *device, qsizetype bufferSize = DefaultBufferSize);
+    ~QProtobufDelimitedWriter();
+
+    /*!
+     * \brief Writes registered qtproto \a message
+     * \return false if buffered data was not written to the device
+     */
+    template<typename T>
+    bool write(const T &message) {
+        //Size of message is calculated first, so size prefix is written before the message data
+        if constexpr (QtProtobufPrivate::HasDirectSerialization<T>::value) {
+            if (m_serializer.supportsDirectWriting()) {
+                QProtobufWireFormat::SizeCache sizes;
+                QProtobufWireFormat::writeLength(message.serializedSize(), m_buffer);
+                message.serializeTo(m_buffer);
+                return flushIfFull();
+            }
+        }
+        writeMessage(&message, T::protobufMetaObject);
+        return flushIfFull();
+    }
+
+    /*!
+     * \brief Writes already serialized message \a data
+     * \return false if buffered data was not written to the device
+     */
+    bool writeRecord(const QByteArray &data);
+
+    /*!
+     * \brief Writes buffered data to the device
+     * \return false if not all data was written
+     */
+    bool flush();
+
+private:
+    void writeMessage(const QObject *message, const QProtobufMetaObject &metaObject);
+    bool flushIfFull();
+
+    Q_DISABLE_COPY_MOVE(QProtobufDelimitedWriter)
+    QIODevice *m_device;
+    const qsizetype m_bufferSize;
+    QByteArray m_buffer;
+    QProtobufSerializer m_serializer;
+};
+
+}
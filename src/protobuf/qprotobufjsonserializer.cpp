@@ -122,7 +122,8 @@ public:
     }
 
     QProtobufJsonSerializerPrivate(QProtobufJsonSerializer *q) : qPtr(q) {
-        if (handlers.empty()) {
+        //Basic type handlers are registered once. Initialization of function-local static is thread-safe
+        static const bool handlersInitialized = [] {
             handlers[qMetaTypeId<QtProtobuf::int32>()] = {{}, QProtobufJsonSerializerPrivate::deserializeInt32};
             handlers[qMetaTypeId<QtProtobuf::sfixed32>()] = {{}, QProtobufJsonSerializerPrivate::deserializeInt32};
             handlers[qMetaTypeId<QtProtobuf::sint32>()] = {{}, QProtobufJsonSerializerPrivate::deserializeInt32};
@@ -152,14 +153,16 @@ public:
             handlers[qMetaTypeId<QtProtobuf::DoubleList>()] = {QProtobufJsonSerializerPrivate::serializeDoubleList, QProtobufJsonSerializerPrivate::deserializeList<double>};
             handlers[qMetaTypeId<QStringList>()] = {QProtobufJsonSerializerPrivate::serializeStringList, QProtobufJsonSerializerPrivate::deserializeStringList};
             handlers[qMetaTypeId<QByteArrayList>()] = {QProtobufJsonSerializerPrivate::serializeBytesList, QProtobufJsonSerializerPrivate::deserializeList<QByteArray>};
-        }
+            return true;
+        }();
+        Q_UNUSED(handlersInitialized)
     }
     ~QProtobufJsonSerializerPrivate() = default;
 
     QByteArray serializeValue(const QVariant &propertyValue, const QProtobufMetaProperty &metaProperty) {
         QByteArray buffer;
         auto userType = propertyValue.userType();
-        auto value = QtProtobufPrivate::findHandler(userType);
+        const auto &value = QtProtobufPrivate::findHandler(userType);
         if (value.serializer) {
             value.serializer(qPtr, propertyValue, metaProperty, buffer);
         } else {
@@ -179,16 +182,10 @@ public:
 
     QByteArray serializeObject(const QObject *object, const QProtobufMetaObject &metaObject) {
         QByteArray result = "{";
-        for (const auto &field : metaObject.propertyOrdering) {
-            int propertyIndex = field.second;
-            int fieldIndex = field.first;
-            Q_ASSERT_X(fieldIndex < 536870912 && fieldIndex > 0, "", "fieldIndex is out of range");
-            QMetaProperty metaProperty = metaObject.staticMetaObject.property(propertyIndex);
-            const char *propertyName = metaProperty.name();
-            const QVariant &propertyValue = object->property(propertyName);
-            result.append(serializeProperty(propertyValue, QProtobufMetaProperty(metaProperty,
-                                                                                 fieldIndex,
-                                                                                 field.second)));
+        //Meta properties are resolved once per message type, values are read by property index
+        for (const auto &metaProperty : metaObject.fields()) {
+            Q_ASSERT_X(metaProperty.protoFieldIndex() < 536870912 && metaProperty.protoFieldIndex() > 0, "", "fieldIndex is out of range");
+            result.append(serializeProperty(metaProperty.read(object), metaProperty));
             result.append(",");
         }
         result.resize(result.size() - 1);//Remove trailing `,`
@@ -313,7 +310,7 @@ public:
 
     QVariant deserializeValue(int type, const QByteArray &data, microjson::JsonType jsonType, bool &ok) {
         QVariant newValue;
-        auto handler = QtProtobufPrivate::findHandler(type);
+        const auto &handler = QtProtobufPrivate::findHandler(type);
         if (handler.deserializer) {
             QtProtobuf::QProtobufSelfcheckIterator it(data);
             QtProtobuf::QProtobufSelfcheckIterator last = it;
@@ -335,15 +332,14 @@ public:
     void deserializeObject(QObject *object, const QProtobufMetaObject &metaObject, const char *data, int size) {
         microjson::JsonObject obj = microjson::parseJsonObject(data, static_cast<size_t>(size));
 
+        const std::vector<QProtobufMetaProperty> &fields = metaObject.fields();
         for (auto &property : obj) {
-            auto name = property.first;
-            auto it = std::find_if(metaObject.propertyOrdering.begin(),
-                                   metaObject.propertyOrdering.end(),
-                                   [&name](const auto &val)->bool {
-                return val.second == QString::fromStdString(name);
+            const QString name = QString::fromStdString(property.first);
+            auto it = std::find_if(fields.begin(), fields.end(), [&name](const QProtobufMetaProperty &field)->bool {
+                return field.jsonPropertyName() == name;
             });
-            if (it != metaObject.propertyOrdering.end()) {
-                QMetaProperty metaProperty = metaObject.staticMetaObject.property(it->second);
+            if (it != fields.end()) {
+                const QProtobufMetaProperty &metaProperty = *it;
                 auto userType = metaProperty.userType();
                 QByteArray rawValue = QByteArray::fromStdString(property.second.value);
                 if (rawValue == "null" && property.second.type == microjson::JsonObjectType) {
@@ -26,17 +26,24 @@
 #pragma once //QProtobufLazyMessagePointer
 
 #include "qtprotobufglobal.h"
+#include "qtprotobuflogging.h"
 #include <QObject>
+#include <QByteArray>
 #if defined(QT_QML_LIB) // TODO: Check how detect this in Qt6
 #  include <QQmlEngine>
 #endif
 
 #include <memory>
 #include <type_traits>
+#include <utility>
+#include <stdexcept>
 
 template <typename T>
 class QProtobufLazyMessagePointer {//TODO: final?
 public:
+    //! \private
+    using Parser = void (*)(T &, const QByteArray &);
+
     QProtobufLazyMessagePointer(T *p = nullptr) : m_ptr(p) {}
 
     virtual ~QProtobufLazyMessagePointer() {
@@ -45,27 +52,27 @@ public:
     }
 
     typename std::add_lvalue_reference<T>::type operator *() const {
-        if (m_ptr == nullptr) {
-            m_ptr.reset(new T);
-        }
-        return *m_ptr;
+        return *get();
     }
 
-    T *operator->() const noexcept {
-        if (m_ptr == nullptr) {
-            m_ptr.reset(new T);
-        }
-        m_ptr.operator->();
+    T *operator->() const {
+        return get();
     }
 
     T *get() const {
         if (m_ptr == nullptr) {
             m_ptr.reset(new T);
         }
+        parseSerializedData();
         return m_ptr.get();
     }
 
     bool operator ==(const QProtobufLazyMessagePointer &other) const {
+        if (this == &other) {
+            return true;
+        }
+        parseSerializedData();
+        other.parseSerializedData();
         if (m_ptr == nullptr) {
             if (other.m_ptr == nullptr)
                 return true;
@@ -94,18 +101,94 @@ public:
         });
 
         m_ptr.reset(p);
+        m_serializedData.clear();
+        m_parser = nullptr;
     }
 
-    QProtobufLazyMessagePointer(QProtobufLazyMessagePointer &&other) : m_ptr(std::move(other.m_ptr)) {}
+    QProtobufLazyMessagePointer(QProtobufLazyMessagePointer &&other) : m_ptr(std::move(other.m_ptr))
+      , m_serializedData(std::move(other.m_serializedData))
+      , m_parser(std::exchange(other.m_parser, nullptr)) {}
     QProtobufLazyMessagePointer &operator =(QProtobufLazyMessagePointer &&other) {
         m_ptr = std::move(other.m_ptr);
+        m_serializedData = std::move(other.m_serializedData);
+        m_parser = std::exchange(other.m_parser, nullptr);
+        return *this;
     }
 
     explicit operator bool() const noexcept {
-        return m_ptr.operator bool();
+        return m_ptr.operator bool() || m_parser != nullptr;
+    }
+
+    /*!
+     * \brief Returns true if pointer holds serialized message data, that was not parsed yet
+     *
+     * \details Serialized data is parsed and dropped on first access to the message.
+     */
+    bool hasSerializedData() const noexcept {
+        return m_parser != nullptr;
+    }
+
+    /*!
+     * \brief Returns serialized message data, that was not parsed yet
+     */
+    const QByteArray &serializedData() const noexcept {
+        return m_serializedData;
+    }
+
+    /*!
+     * \brief Stores serialized message \a data, that is parsed using \a parser on first access to the message
+     *
+     * \details If pointer already holds serialized data, \a data is appended to it, that merges messages in the same
+     *          way as protobuf parsers do for repeated occurrences of message field. If message was already accessed,
+     *          \a data is parsed immediately.
+     */
+    void appendSerializedData(const QByteArray &data, Parser parser) {
+        if (m_ptr != nullptr && m_parser == nullptr) {
+            parser(*m_ptr, data);
+            return;
+        }
+        if (m_parser == nullptr) {
+            m_serializedData = data;
+        } else {
+            m_serializedData.append(data);
+        }
+        m_parser = parser;
+    }
+
+    /*!
+     * \brief Replaces message with serialized message data, that \a other holds
+     *
+     * \details Used to copy messages without parsing data, that was not accessed yet.
+     */
+    void copySerializedData(const QProtobufLazyMessagePointer &other) {
+        if (this == &other) {
+            return;
+        }
+        if (m_ptr != nullptr) {
+            *m_ptr = T{};
+        }
+        m_serializedData = other.m_serializedData;
+        m_parser = other.m_parser;
     }
 
 private:
+    void parseSerializedData() const {
+        if (m_parser == nullptr) {
+            return;
+        }
+        if (m_ptr == nullptr) {
+            m_ptr.reset(new T);
+        }
+        //Message is considered modified after first access, so serialized data is dropped before parsing
+        const Parser parser = std::exchange(m_parser, nullptr);
+        const QByteArray data = std::exchange(m_serializedData, QByteArray());
+        try {
+            parser(*m_ptr, data);
+        } catch (const std::exception &e) {
+            qProtoWarning() << "Unable to parse message data on access:" << e.what();
+        }
+    }
+
     void checkAndRelease() const {
 #if defined(QT_QML_LIB)
         bool qmlCheck = QQmlEngine::objectOwnership(m_ptr.get()) == QQmlEngine::JavaScriptOwnership;
@@ -122,4 +205,6 @@ private:
     QProtobufLazyMessagePointer &operator =(const QProtobufLazyMessagePointer&) = delete;
     mutable std::unique_ptr<T> m_ptr;
     mutable QMetaObject::Connection m_destroyed;
+    mutable QByteArray m_serializedData;
+    mutable Parser m_parser = nullptr;
 };
@@ -0,0 +1,139 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once //QProtobufLazyString
+
+#include <QString>
+#include <QByteArray>
+
+#include <utility>
+
+#include "qtprotobufglobal.h"
+
+namespace QtProtobuf {
+
+/*!
+ * \ingroup QtProtobuf
+ * \brief The QProtobufLazyString class holds value of string field, that is decoded from UTF-8 on first access
+ *
+ * \details Messages generated with LAZY_PARSING option store string fields in QProtobufLazyString. When message is
+ *          deserialized, UTF-8 bytes of the field are kept as is and converted to QString only when the field is
+ *          read. Original bytes are kept until new value is assigned, so messages that are deserialized and
+ *          serialized back, write string fields without any transcoding, even if fields were read meanwhile.
+ *
+ *          QProtobufLazyString is implicitly convertible to and from QString, and might be used in place of it.
+ */
+class Q_PROTOBUF_EXPORT QProtobufLazyString final
+{
+public:
+    QProtobufLazyString() = default;
+    QProtobufLazyString(const QString &value) : m_string(value) {}
+    QProtobufLazyString(QString &&value) : m_string(std::move(value)) {}
+
+    QProtobufLazyString &operator =(const QString &value) {
+        m_string = value;
+        resetUtf8();
+        return *this;
+    }
+
+    QProtobufLazyString &operator =(QString &&value) {
+        m_string = std::move(value);
+        resetUtf8();
+        return *this;
+    }
+
+    /*!
+     * \brief Constructs string that holds UTF-8 encoded \a utf8 data
+     *
+     * \details Data is not validated and not decoded until string value is accessed.
+     */
+    static QProtobufLazyString fromUtf8(const QByteArray &utf8) {
+        QProtobufLazyString result;
+        result.m_utf8 = utf8;
+        result.m_hasUtf8 = true;
+        result.m_decoded = false;
+        return result;
+    }
+
+    /*!
+     * \brief Returns string value, decoding it from UTF-8 data if it's not decoded yet
+     */
+    const QString &toString() const {
+        if (!m_decoded) {
+            decode();
+        }
+        return m_string;
+    }
+
+    operator const QString &() const {
+        return toString();
+    }
+
+    /*!
+     * \brief Returns true if string holds UTF-8 encoded data of the current value
+     */
+    bool hasUtf8() const noexcept { return m_hasUtf8; }
+
+    /*!
+     * \brief Returns UTF-8 encoded data of the current value, if hasUtf8() is true, otherwise returns empty array
+     */
+    const QByteArray &utf8() const noexcept { return m_utf8; }
+
+    /*!
+     * \brief Returns true if value was already decoded from UTF-8 data
+     */
+    bool isDecoded() const noexcept { return m_decoded; }
+
+    bool isEmpty() const noexcept {
+        return m_decoded ? m_string.isEmpty() : m_utf8.isEmpty();
+    }
+
+    bool operator ==(const QProtobufLazyString &other) const;
+    bool operator !=(const QProtobufLazyString &other) const {
+        return !operator ==(other);
+    }
+
+    bool operator ==(const QString &other) const {
+        return toString() == other;
+    }
+    bool operator !=(const QString &other) const {
+        return toString() != other;
+    }
+
+private:
+    void decode() const;
+    void resetUtf8() {
+        m_utf8.clear();
+        m_hasUtf8 = false;
+        m_decoded = true;
+    }
+
+    mutable QString m_string;
+    QByteArray m_utf8;
+    bool m_hasUtf8 = false;
+    mutable bool m_decoded = true;
+};
+
+}
@@ -24,9 +24,44 @@
  */
 
 #include "qprotobufmetaobject.h"
+#include "qprotobufserializer_p.h"
+
+#include <algorithm>
+
 using namespace QtProtobuf;
-QProtobufMetaObject::QProtobufMetaObject(const QMetaObject &_staticMetaObject, const QProtobufPropertyOrdering &_propertyOrdering)
+QProtobufMetaObject::QProtobufMetaObject(const QMetaObject &_staticMetaObject, const QProtobufPropertyOrdering &_propertyOrdering,
+                                         UnknownFieldsAccessor _unknownFieldsAccessor)
     : staticMetaObject(_staticMetaObject)
     , propertyOrdering(_propertyOrdering)
+    , m_unknownFieldsAccessor(_unknownFieldsAccessor)
+{
+}
+
+QProtobufMetaObject::~QProtobufMetaObject() = default;
+
+const QProtobufFieldDispatchTable &QProtobufMetaObject::dispatchTable() const
 {
+    //Table is built separately from fields, since basic type handlers are registered by protobuf serializer
+    std::call_once(m_dispatchTableBuilt, [this] {
+        m_dispatchTable = std::make_unique<QProtobufFieldDispatchTable>(fields());
+    });
+    return *m_dispatchTable;
+}
+
+void QProtobufMetaObject::resolveFields() const
+{
+    std::vector<QProtobufPropertyOrdering::const_iterator> ordering;
+    ordering.reserve(propertyOrdering.size());
+    for (auto it = propertyOrdering.cbegin(); it != propertyOrdering.cend(); ++it) {
+        ordering.push_back(it);
+    }
+    std::sort(ordering.begin(), ordering.end(), [](const auto &a, const auto &b) {
+        return a->first < b->first;
+    });
+
+    //Meta properties reference json names stored in property ordering, that is static data of message type
+    m_fields.reserve(ordering.size());
+    for (const auto &field : ordering) {
+        m_fields.emplace_back(staticMetaObject.property(field->second.qtProperty), field->first, field->second.jsonName);
+    }
 }
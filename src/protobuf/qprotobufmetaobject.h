@@ -27,10 +27,18 @@
 
 #include "qtprotobufglobal.h"
 #include "qtprotobuftypes.h"
+#include "qprotobufunknownfields.h"
+#include "qprotobufmetaproperty.h"
 
 #include <QMetaObject>
+
+#include <memory>
+#include <mutex>
+#include <vector>
 namespace QtProtobuf {
 
+class QProtobufFieldDispatchTable;
+
 /*!
  * \ingroup QtProtobuf
  * \private
@@ -39,11 +47,52 @@ namespace QtProtobuf {
 class Q_PROTOBUF_EXPORT QProtobufMetaObject
 {
 public:
-    QProtobufMetaObject(const QMetaObject &staticMetaObject, const QProtobufPropertyOrdering &propertyOrdering);
+    QProtobufMetaObject(const QMetaObject &staticMetaObject, const QProtobufPropertyOrdering &propertyOrdering,
+                        UnknownFieldsAccessor unknownFieldsAccessor = nullptr);
+    ~QProtobufMetaObject();
+
+    /*!
+     * \brief Returns unknown fields storage of \a object or nullptr if message doesn't preserve unknown fields
+     */
+    QProtobufUnknownFields *unknownFields(QObject *object) const {
+        return m_unknownFieldsAccessor != nullptr ? m_unknownFieldsAccessor(object) : nullptr;
+    }
+
+    const QProtobufUnknownFields *unknownFields(const QObject *object) const {
+        return unknownFields(const_cast<QObject *>(object));
+    }
+
+    /*!
+     * \brief Returns meta properties of message fields in ascending field number order
+     *
+     * \details Properties are resolved once, when fields are requested first time, and are not changed afterwards.
+     *          Values of fields might be read and written by index using returned meta properties, without lookup
+     *          of properties by name.
+     */
+    const std::vector<QProtobufMetaProperty> &fields() const {
+        std::call_once(m_fieldsResolved, [this] { resolveFields(); });
+        return m_fields;
+    }
+
+    /*!
+     * \private
+     * \brief Returns field dispatch table of protobuf serializer
+     *
+     * \details Table is built once, when it's requested first time by protobuf serializer.
+     */
+    const QProtobufFieldDispatchTable &dispatchTable() const;
+
     const QMetaObject &staticMetaObject;
     const QProtobufPropertyOrdering &propertyOrdering;
 private:
     QProtobufMetaObject();
+    void resolveFields() const;
+
+    UnknownFieldsAccessor m_unknownFieldsAccessor;
+    mutable std::once_flag m_fieldsResolved;
+    mutable std::vector<QProtobufMetaProperty> m_fields;
+    mutable std::once_flag m_dispatchTableBuilt;
+    mutable std::unique_ptr<QProtobufFieldDispatchTable> m_dispatchTable;
 };
 
 }
@@ -27,6 +27,7 @@
 
 #include "qabstractprotobufserializer.h"
 #include "qprotobufmetaobject.h"
+#include "qprotobufunknownfields.h"
 #include <unordered_map>
 
 /*!
@@ -43,17 +44,25 @@
 #define Q_DECLARE_PROTOBUF_SERIALIZERS(T)\
     public:\
         QByteArray serialize(QtProtobuf::QAbstractProtobufSerializer *serializer) const { Q_ASSERT_X(serializer != nullptr, "QProtobufObject", "Serializer is null"); return serializer->serialize<T>(this); }\
+        void serialize(QtProtobuf::QAbstractProtobufSerializer *serializer, QByteArray &out) const { Q_ASSERT_X(serializer != nullptr, "QProtobufObject", "Serializer is null"); serializer->serialize<T>(this, out); }\
+        bool serialize(QtProtobuf::QAbstractProtobufSerializer *serializer, QIODevice *device) const { Q_ASSERT_X(serializer != nullptr, "QProtobufObject", "Serializer is null"); return serializer->serialize<T>(this, device); }\
         void deserialize(QtProtobuf::QAbstractProtobufSerializer *serializer, const QByteArray &array) { Q_ASSERT_X(serializer != nullptr, "QProtobufObject", "Serializer is null"); serializer->deserialize<T>(this, array); }\
+        void deserialize(QtProtobuf::QAbstractProtobufSerializer *serializer, const QByteArray &array, QtProtobuf::QAbstractProtobufSerializer::DeserializationMode mode, QtProtobuf::QAbstractProtobufSerializer::NotificationMode notificationMode = QtProtobuf::QAbstractProtobufSerializer::ImmediateNotifications) { Q_ASSERT_X(serializer != nullptr, "QProtobufObject", "Serializer is null"); serializer->deserialize<T>(this, array, mode, notificationMode); }\
+        QtProtobuf::QProtobufDecodeResult tryDeserialize(QtProtobuf::QAbstractProtobufSerializer *serializer, const QByteArray &array, QtProtobuf::QAbstractProtobufSerializer::DeserializationMode mode = QtProtobuf::QAbstractProtobufSerializer::CopyDeserialization, QtProtobuf::QAbstractProtobufSerializer::NotificationMode notificationMode = QtProtobuf::QAbstractProtobufSerializer::ImmediateNotifications) { Q_ASSERT_X(serializer != nullptr, "QProtobufObject", "Serializer is null"); return serializer->tryDeserialize<T>(this, array, mode, notificationMode); }\
     private:
 
 /*!
  * \ingroup QtProtobuf
  * \def Q_PROTOBUF_OBJECT
  *      Declares propertyOrdering for type T inherited of QObject. Is part of autogenerated by qtprogobufgenerator classes
+ *      Also declares storage of fields that are not known to the message type, but were received while deserializing.
  */
 
 #define Q_PROTOBUF_OBJECT\
     public:\
         static const QtProtobuf::QProtobufPropertyOrdering propertyOrdering;\
         static const QtProtobuf::QProtobufMetaObject protobufMetaObject;\
-    private:
+        const QtProtobuf::QProtobufUnknownFields &unknownFields() const { return m_unknownFields; }\
+        QtProtobuf::QProtobufUnknownFields &unknownFields() { return m_unknownFields; }\
+    private:\
+        QtProtobuf::QProtobufUnknownFields m_unknownFields;
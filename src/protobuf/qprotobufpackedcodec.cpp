@@ -0,0 +1,160 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "qprotobufpackedcodec_p.h"
+
+#include <QtAlgorithms>
+
+#if defined(Q_PROCESSOR_X86) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#  define QT_PROTOBUF_SSE2
+#  include <emmintrin.h>
+#endif
+
+#if defined(QT_PROTOBUF_SSE2) && defined(__GNUC__)
+#  define QT_PROTOBUF_AVX2
+#  include <immintrin.h>
+#endif
+
+using namespace QtProtobuf;
+
+namespace {
+
+/*!
+ * \private
+ * \brief The ChunkScanner struct contains SIMD routines that analyze chunk of packed varints
+ *
+ * \details terminators returns the bit mask of bytes with the most significant bit cleared, that terminate varints.
+ *          Bit 0 of mask corresponds to the first byte of chunk.
+ */
+struct ChunkScanner {
+    int width;
+    quint32 (*terminators)(const char *chunk);
+};
+
+#ifdef QT_PROTOBUF_SSE2
+quint32 terminatorsSse2(const char *chunk)
+{
+    const __m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i *>(chunk));
+    return ~static_cast<quint32>(_mm_movemask_epi8(data)) & 0xffff;
+}
+#endif
+
+#ifdef QT_PROTOBUF_AVX2
+__attribute__((target("avx2")))
+quint32 terminatorsAvx2(const char *chunk)
+{
+    const __m256i data = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(chunk));
+    return ~static_cast<quint32>(_mm256_movemask_epi8(data));
+}
+#endif
+
+const ChunkScanner &chunkScanner()
+{
+    static const ChunkScanner scanner = []() -> ChunkScanner {
+#ifdef QT_PROTOBUF_AVX2
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) {
+            return { 32, terminatorsAvx2 };
+        }
+#endif
+#ifdef QT_PROTOBUF_SSE2
+        return { 16, terminatorsSse2 };
+#else
+        return { 0, nullptr };
+#endif
+    }();
+    return scanner;
+}
+
+template <typename T>
+void decodeVarintsCommon(const char *it, const char *end, T *out, qsizetype count)
+{
+    qsizetype index = 0;
+    const ChunkScanner &scanner = chunkScanner();
+    if (scanner.width > 0) {
+        const quint32 fullMask = scanner.width == 32 ? 0xffffffffu : ((1u << scanner.width) - 1);
+        while (end - it >= scanner.width) {
+            const quint32 mask = scanner.terminators(it);
+            //Leading terminator bytes are single-byte varints, that are copied as is
+            const int singles = mask == fullMask ? scanner.width : qCountTrailingZeroBits(~mask);
+            for (int i = 0; i < singles; ++i) {
+                out[index + i] = static_cast<uchar>(it[i]);
+            }
+            index += singles;
+            it += singles;
+            if (singles < scanner.width) {
+                uint64_t value = 0;
+                it = QProtobufPackedCodec::readVarint(it, end, value);
+                out[index++] = static_cast<T>(value);
+            }
+        }
+    }
+
+    while (index < count) {
+        uint64_t value = 0;
+        it = QProtobufPackedCodec::readVarint(it, end, value);
+        out[index++] = static_cast<T>(value);
+    }
+    Q_ASSERT(it == end);
+}
+
+}
+
+qsizetype QProtobufPackedCodec::countVarints(const char *begin, const char *end)
+{
+    if (begin == end) {
+        return 0;
+    }
+
+    if ((static_cast<uchar>(*(end - 1)) & 0b10000000) != 0) {
+        throw std::out_of_range("Container is less than required fields number. Deserialization failed");
+    }
+
+    qsizetype count = 0;
+    const char *it = begin;
+    const ChunkScanner &scanner = chunkScanner();
+    if (scanner.width > 0) {
+        for (; end - it >= scanner.width; it += scanner.width) {
+            count += qPopulationCount(scanner.terminators(it));
+        }
+    }
+
+    for (; it != end; ++it) {
+        if ((static_cast<uchar>(*it) & 0b10000000) == 0) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+void QProtobufPackedCodec::decodeVarints(const char *begin, const char *end, uint32_t *out, qsizetype count)
+{
+    decodeVarintsCommon(begin, end, out, count);
+}
+
+void QProtobufPackedCodec::decodeVarints(const char *begin, const char *end, uint64_t *out, qsizetype count)
+{
+    decodeVarintsCommon(begin, end, out, count);
+}
@@ -0,0 +1,175 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once //QProtobufPackedCodec
+
+#include <QtGlobal>
+#include <QtEndian>
+
+#include <stdexcept>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace QtProtobuf {
+
+/*!
+ * \ingroup QtProtobuf
+ * \private
+ * \brief The QProtobufPackedCodec class contains low-level routines for varints and packed repeated fields
+ *
+ * \details Bulk decoding of packed varints uses SIMD instructions when available. SSE2 is used on x86 by default,
+ *          AVX2 is selected at runtime if CPU supports it. Scalar implementation is used on other platforms.
+ */
+class QProtobufPackedCodec final
+{
+public:
+    //! Maximum number of bytes in varint encoded 64-bit value
+    static constexpr int MaxVarintSize = 10;
+
+    /*!
+     * \brief Decodes varint from the span [\a it, \a end)
+     *
+     * \details Remaining length is checked once: if at least MaxVarintSize bytes are available the varint is
+     *          decoded without any bounds checks, otherwise every byte is checked against \a end.
+     *
+     * \param[in] it Pointer to the first byte of varint
+     * \param[in] end Pointer to the end of span
+     * \param[out] value Decoded value
+     * \return Pointer to the byte next to decoded varint
+     */
+    static const char *readVarint(const char *it, const char *end, uint64_t &value) {
+        uint64_t result = 0;
+        if (end - it >= MaxVarintSize) {
+            for (int shift = 0; shift < 64; shift += 7) {
+                const uint64_t byte = static_cast<uchar>(*it++);
+                result |= (byte & 0b01111111) << shift;
+                if ((byte & 0b10000000) == 0) {
+                    value = result;
+                    return it;
+                }
+            }
+        } else {
+            for (int shift = 0; shift < 64 && it != end; shift += 7) {
+                const uint64_t byte = static_cast<uchar>(*it++);
+                result |= (byte & 0b01111111) << shift;
+                if ((byte & 0b10000000) == 0) {
+                    value = result;
+                    return it;
+                }
+            }
+            if (it == end) {
+                throw std::out_of_range("Container is less than required fields number. Deserialization failed");
+            }
+        }
+        throw std::invalid_argument("Varint is longer than 10 bytes. Deserialization failed");
+    }
+
+    /*!
+     * \brief Decodes varint from \a it, if data up to \a end contains complete varint
+     * \return Pointer to the byte next to decoded varint, or nullptr if data ends before varint is complete
+     */
+    static const char *tryReadVarint(const char *it, const char *end, uint64_t &value) {
+        if (end - it < MaxVarintSize) {
+            const char *last = it;
+            while (last != end && (static_cast<uchar>(*last) & 0b10000000) != 0) {
+                ++last;
+            }
+            if (last == end) {
+                return nullptr;
+            }
+        }
+        return readVarint(it, end, value);
+    }
+
+    /*!
+     * \brief Encodes \a value as varint to \a dst. \a dst must have enough space.
+     * \return Pointer to the byte next to encoded varint
+     */
+    template <typename V,
+              typename std::enable_if_t<std::is_integral<V>::value
+                                        && std::is_unsigned<V>::value, int> = 0>
+    static char *encodeVarint(V value, char *dst) {
+        while (value >= 0b10000000) {
+            //Put 7 bits to buffer and mark as "not last" (0b10000000)
+            *dst++ = static_cast<char>((value & 0b01111111) | 0b10000000);
+            //Divide values to chunks of 7 bits and move to next chunk
+            value >>= 7;
+        }
+        *dst++ = static_cast<char>(value);
+        return dst;
+    }
+
+    /*!
+     * \brief Counts varints in the span [\a begin, \a end), that is number of bytes with the most significant bit cleared
+     *
+     * \details Throws std::out_of_range if last varint in the span is incomplete.
+     */
+    static qsizetype countVarints(const char *begin, const char *end);
+
+    /*!
+     * \brief Decodes \a count varints from the span [\a begin, \a end) to \a out
+     *
+     * \details \a count must be calculated using countVarints for the same span. Values are truncated to 32 bits for
+     *          32-bit output. Decoded values are raw, ZigZag decoding is not applied.
+     */
+    static void decodeVarints(const char *begin, const char *end, uint32_t *out, qsizetype count);
+    static void decodeVarints(const char *begin, const char *end, uint64_t *out, qsizetype count);
+
+    /*!
+     * \brief Copies \a count fixed-width values from little-endian wire representation \a src to \a out
+     *
+     * \details Single memcpy is used on little-endian hosts, values are byte-swapped on big-endian hosts.
+     */
+    template <typename V>
+    static void readFixed(const char *src, V *out, qsizetype count) {
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+        std::memcpy(static_cast<void *>(out), src, count * sizeof(V));
+#else
+        qFromLittleEndian<FixedRawType<V>>(src, count, out);
+#endif
+    }
+
+    /*!
+     * \brief Copies \a count fixed-width values from \a values to little-endian wire representation \a dst
+     *
+     * \details Single memcpy is used on little-endian hosts, values are byte-swapped on big-endian hosts.
+     */
+    template <typename V>
+    static void writeFixed(const V *values, char *dst, qsizetype count) {
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+        std::memcpy(dst, static_cast<const void *>(values), count * sizeof(V));
+#else
+        qToLittleEndian<FixedRawType<V>>(values, count, dst);
+#endif
+    }
+
+private:
+    //! Integral type of the same size as fixed-width type \a V, used for byte swapping
+    template <typename V>
+    using FixedRawType = std::conditional_t<sizeof(V) == sizeof(quint64), quint64, quint32>;
+};
+
+}
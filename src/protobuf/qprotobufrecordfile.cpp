@@ -0,0 +1,112 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+
+#include "qprotobufrecordfile.h"
+#include "qprotobufpackedcodec_p.h"
+
+#include <stdexcept>
+
+using namespace QtProtobuf;
+
+QProtobufRecordFile::QProtobufRecordFile(const QString &fileName) : m_file(fileName)
+{
+}
+
+QProtobufRecordFile::~QProtobufRecordFile()
+{
+    close();
+}
+
+bool QProtobufRecordFile::open()
+{
+    close();
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        qProtoWarning() << "Unable to open" << m_file.fileName() << m_file.errorString();
+        return false;
+    }
+
+    m_size = m_file.size();
+    if (m_size == 0) {
+        //Empty file can't be mapped, but it's valid file without records
+        return true;
+    }
+
+    m_data = reinterpret_cast<const char *>(m_file.map(0, m_size));
+    if (m_data == nullptr) {
+        qProtoWarning() << "Unable to map" << m_file.fileName() << m_file.errorString();
+        m_file.close();
+        m_size = 0;
+        return false;
+    }
+    return true;
+}
+
+void QProtobufRecordFile::close()
+{
+    if (m_data != nullptr) {
+        m_file.unmap(reinterpret_cast<uchar *>(const_cast<char *>(m_data)));
+        m_data = nullptr;
+    }
+    m_file.close();
+    m_size = 0;
+    m_index.clear();
+}
+
+QByteArray QProtobufRecordFile::recordAt(qsizetype offset, qsizetype *nextOffset) const
+{
+    if (offset < 0 || offset >= m_size) {
+        throw std::out_of_range("Record offset is out of file bounds");
+    }
+
+    uint64_t recordSize = 0;
+    const char *begin = m_data + offset;
+    const char *end = m_data + m_size;
+    const char *recordBegin = QProtobufPackedCodec::tryReadVarint(begin, end, recordSize);
+    if (recordBegin == nullptr || recordSize > static_cast<uint64_t>(end - recordBegin)) {
+        throw std::out_of_range("Record exceeds file size. File is truncated");
+    }
+
+    if (nextOffset != nullptr) {
+        *nextOffset = (recordBegin - m_data) + static_cast<qsizetype>(recordSize);
+    }
+    return QByteArray::fromRawData(recordBegin, static_cast<qsizetype>(recordSize));
+}
+
+void QProtobufRecordFile::buildIndex()
+{
+    m_index.clear();
+    qsizetype offset = 0;
+    while (offset < m_size) {
+        m_index.append(offset);
+        recordAt(offset, &offset);
+    }
+}
+
+QByteArray QProtobufRecordFile::record(qsizetype index) const
+{
+    if (index < 0 || index >= m_index.size()) {
+        throw std::out_of_range("Record index is out of range");
+    }
+    return recordAt(m_index.at(index));
+}
@@ -0,0 +1,191 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+
+#pragma once //QProtobufRecordFile
+
+#include <QByteArray>
+#include <QFile>
+#include <QList>
+#include <QString>
+
+#include <iterator>
+
+#include "qtprotobufglobal.h"
+#include "qprotobufserializer.h"
+
+namespace QtProtobuf {
+
+/*!
+ * \ingroup QtProtobuf
+ * \brief The QProtobufRecordFile class provides read access to file with sequence of size-delimited messages
+ *        written by QProtobufDelimitedWriter
+ *
+ * \details File is mapped to memory and records are accessed without copying. Records are iterated by offset using
+ *          const_iterator. buildIndex() scans the file once and stores offsets of records, after that any record
+ *          is accessed in constant time.
+ *
+ *          Records returned by the class point to the mapped memory and are valid while file is open. Messages are
+ *          deserialized from the mapped memory directly, only string, bytes and unknown fields are copied to
+ *          message.
+ *
+ *          Functions throw std::out_of_range if record exceeds file size.
+ *
+ * \code
+ * QtProtobuf::QProtobufRecordFile file("session.bin");
+ * file.open();
+ * file.buildIndex();
+ * Quote quote;
+ * file.read(file.recordCount() / 2, &quote);
+ * \endcode
+ */
+class Q_PROTOBUF_EXPORT QProtobufRecordFile final
+{
+public:
+    /*!
+     * \brief The const_iterator class iterates records of the file in order they were written
+     */
+    class const_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = QByteArray;
+        using difference_type = qsizetype;
+        using pointer = const QByteArray *;
+        using reference = const QByteArray &;
+
+        const_iterator() = default;
+
+        reference operator*() const { return m_record; }
+        pointer operator->() const { return &m_record; }
+
+        /*!
+         * \brief Returns offset of the record in file
+         */
+        qsizetype offset() const { return m_offset; }
+
+        const_iterator &operator++() {
+            m_offset = m_nextOffset;
+            readRecord();
+            return *this;
+        }
+
+        const_iterator operator++(int) {
+            const_iterator result = *this;
+            operator++();
+            return result;
+        }
+
+        bool operator==(const const_iterator &other) const { return m_offset == other.m_offset; }
+        bool operator!=(const const_iterator &other) const { return m_offset != other.m_offset; }
+
+    private:
+        friend class QProtobufRecordFile;
+        const_iterator(const QProtobufRecordFile *file, qsizetype offset) : m_file(file)
+          , m_offset(offset) {
+            readRecord();
+        }
+
+        void readRecord() {
+            if (m_offset < m_file->size()) {
+                m_record = m_file->recordAt(m_offset, &m_nextOffset);
+            } else {
+                m_record = QByteArray();
+            }
+        }
+
+        const QProtobufRecordFile *m_file = nullptr;
+        qsizetype m_offset = 0;
+        qsizetype m_nextOffset = 0;
+        QByteArray m_record;
+    };
+
+    explicit QProtobufRecordFile(const QString &fileName);
+    ~QProtobufRecordFile();
+
+    /*!
+     * \brief Opens and maps file to memory
+     * \return false if file can't be opened or mapped
+     */
+    bool open();
+
+    /*!
+     * \brief Unmaps and closes file. Records returned before become invalid
+     */
+    void close();
+
+    bool isOpen() const { return m_file.isOpen(); }
+
+    /*!
+     * \brief Returns file size in bytes
+     */
+    qsizetype size() const { return m_size; }
+
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, m_size); }
+
+    /*!
+     * \brief Returns record at \a offset, and stores offset of next record in \a nextOffset, if it's not nullptr
+     */
+    QByteArray recordAt(qsizetype offset, qsizetype *nextOffset = nullptr) const;
+
+    /*!
+     * \brief Scans file and stores offsets of all records
+     */
+    void buildIndex();
+
+    /*!
+     * \brief Returns number of records in the file. Is valid after buildIndex() call
+     */
+    qsizetype recordCount() const { return m_index.size(); }
+
+    /*!
+     * \brief Returns record by its \a index. Requires buildIndex() to be called
+     */
+    QByteArray record(qsizetype index) const;
+
+    /*!
+     * \brief Deserializes record with \a index to registered qtproto \a message. Requires buildIndex() to be called
+     */
+    template<typename T>
+    void read(qsizetype index, T *message) {
+        m_serializer.deserialize<T>(message, record(index));
+    }
+
+    /*!
+     * \brief Deserializes record at \a offset to registered qtproto \a message
+     */
+    template<typename T>
+    void readAt(qsizetype offset, T *message) {
+        m_serializer.deserialize<T>(message, recordAt(offset));
+    }
+
+private:
+    Q_DISABLE_COPY_MOVE(QProtobufRecordFile)
+    QFile m_file;
+    const char *m_data = nullptr;
+    qsizetype m_size = 0;
+    QList<qsizetype> m_index;
+    QProtobufSerializer m_serializer;
+};
+
+}
@@ -41,11 +41,13 @@ class Q_PROTOBUF_EXPORT QProtobufSelfcheckIterator
 public:
     QProtobufSelfcheckIterator(const QByteArray &container) : m_sizeLeft(container.size())
       , m_containerSize(container.size())
-      , m_it(container.begin()) {}
+      , m_it(container.begin())
+      , m_container(&container) {}
 
     QProtobufSelfcheckIterator(const QProtobufSelfcheckIterator &other) : m_sizeLeft(other.m_sizeLeft)
       , m_containerSize(other.m_containerSize)
-      , m_it(other.m_it) {
+      , m_it(other.m_it)
+      , m_container(other.m_container) {
         if (m_sizeLeft > m_containerSize || m_sizeLeft < 0) {
             throw std::out_of_range("Container is less than required fields number. Deserialization failed");
         }
@@ -103,6 +105,7 @@ public:
             throw std::out_of_range("Container is less than required fields number. Deserialization failed");
         }
         m_it = other.m_it;
+        m_container = other.m_container;
         return *this;
     }
 
@@ -129,10 +132,36 @@ public:
     int size() const {
         return m_sizeLeft;
     }
+
+    /*!
+     * \brief Creates iterator that points to the same position, but limited by \a length bytes
+     *
+     * \details Bounded iterator is used to process nested data in place, without copying it.
+     *          Iterator is not moved.
+     */
+    QProtobufSelfcheckIterator bounded(int length) const {
+        if (length < 0 || length > m_sizeLeft) {
+            throw std::out_of_range("Container is less than required fields number. Deserialization failed");
+        }
+        return QProtobufSelfcheckIterator(m_it, length, m_container);
+    }
+
+    /*!
+     * \brief Returns the byte array iterator was initially created for
+     */
+    const QByteArray *container() const {
+        return m_container;
+    }
 private:
+    QProtobufSelfcheckIterator(QByteArray::const_iterator it, int size, const QByteArray *container) : m_sizeLeft(size)
+      , m_containerSize(size)
+      , m_it(it)
+      , m_container(container) {}
+
     int m_sizeLeft;
     int m_containerSize;
     QByteArray::const_iterator m_it;
+    const QByteArray *m_container;
 };
 
 inline QProtobufSelfcheckIterator operator +(const QProtobufSelfcheckIterator &it, int lenght) {
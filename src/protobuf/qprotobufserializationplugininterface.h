@@ -90,6 +90,10 @@ public:
      * \brief Method finds and returns pointer to specific serialization implementation by serializer name, otherwise returns nullptr.
      * \param[in] name of specific serializer that should be supplied by plugin.
      * \return An object to serializer realization.
+     *
+     * \details Method is called once per thread by QProtobufSerializerRegistry::acquireSerializer. Serializer,
+     *          that is not thread-safe, should be created on each call, since returned instance is used
+     *          without synchronization.
      */
     virtual std::shared_ptr<QtProtobuf::QAbstractProtobufSerializer> serializer(const QString &serializerName) = 0;
 };
@@ -29,91 +29,429 @@
 #include "qprotobufmetaproperty.h"
 #include "qprotobufmetaobject.h"
 
+#include <QIODevice>
+#include <QtEndian>
+#include <QtAlgorithms>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  include <emmintrin.h>
+#  define QT_PROTOBUF_UTF8_SSE2
+#endif
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
 namespace QtProtobuf {
 
-template<>
-QByteArray QProtobufSerializerPrivate::serializeListType<QByteArray>(const QByteArrayList &listValue, int &outFieldIndex)
-{
-    qProtoDebug() << __func__ << "listValue.count" << listValue.count() << "outFiledIndex" << outFieldIndex;
+namespace {
 
-    if (listValue.count() <= 0) {
-        outFieldIndex = QtProtobufPrivate::NotUsedFieldIndex;
-        return QByteArray();
-    }
+//! \private Size of chunks used while serializing to QIODevice
+constexpr qsizetype StreamChunkSize = 64 * 1024;
 
-    QByteArray serializedList;
-    for (auto &value : listValue) {
-        serializedList.append(QProtobufSerializerPrivate::encodeHeader(outFieldIndex, LengthDelimited));
-        serializedList.append(serializeLengthDelimited(value));
+//! \private Minimal number of directly indexed entries in field dispatch table
+constexpr int MinimumDenseFieldNumber = 64;
+//! \private Ratio between directly indexed entries and number of fields in field dispatch table
+constexpr int DenseFieldRatio = 4;
+
+//! \private Maximum field number allowed by protobuf
+constexpr uint64_t MaxFieldNumber = (1 << 29) - 1;
+
+/*!
+ * \private
+ * \brief Decodes varint from \a it up to \a end without throwing on malformed data
+ *
+ * \details \a it is moved next to decoded varint, if varint is decoded successfully.
+ */
+QProtobufDecodeResult::Status scanVarint(const char *&it, const char *end, uint64_t &value)
+{
+    value = 0;
+    const char *current = it;
+    for (int i = 0; i < QProtobufPackedCodec::MaxVarintSize; ++i) {
+        if (current == end) {
+            return QProtobufDecodeResult::TruncatedData;
+        }
+        const uchar byte = static_cast<uchar>(*current++);
+        value |= static_cast<uint64_t>(byte & 0b01111111) << (7 * i);
+        if ((byte & 0b10000000) == 0) {
+            it = current;
+            return QProtobufDecodeResult::NoError;
+        }
     }
+    return QProtobufDecodeResult::MalformedVarint;
+}
 
-    outFieldIndex = QtProtobufPrivate::NotUsedFieldIndex;
-    return serializedList;
+/*!
+ * \private
+ * \brief Returns WireType of elements of packed basic type list \a userType, or UnknownWireType
+ */
+WireTypes packedElementWireType(int userType)
+{
+    static const std::unordered_map<int, WireTypes> packedTypes = {
+        {qMetaTypeId<FloatList>(), Fixed32},
+        {qMetaTypeId<DoubleList>(), Fixed64},
+        {qMetaTypeId<fixed32List>(), Fixed32},
+        {qMetaTypeId<fixed64List>(), Fixed64},
+        {qMetaTypeId<sfixed32List>(), Fixed32},
+        {qMetaTypeId<sfixed64List>(), Fixed64},
+        {qMetaTypeId<int32List>(), Varint},
+        {qMetaTypeId<int64List>(), Varint},
+        {qMetaTypeId<sint32List>(), Varint},
+        {qMetaTypeId<sint64List>(), Varint},
+        {qMetaTypeId<uint32List>(), Varint},
+        {qMetaTypeId<uint64List>(), Varint}
+    };
+    auto it = packedTypes.find(userType);
+    return it != packedTypes.end() ? it->second : UnknownWireType;
 }
 
-template<>
-void QProtobufSerializerPrivate::deserializeList<QByteArray>(QProtobufSelfcheckIterator &it, QVariant &previousValue)
+/*!
+ * \private
+ * \brief Returns decoder of packed basic type list \a userType, or nullptr
+ */
+QProtobufSerializerPrivate::PackedDecoder packedDecoder(int userType)
 {
-    qProtoDebug() << __func__ << "currentByte:" << QString::number((*it), 16);
+    static const std::unordered_map<int, QProtobufSerializerPrivate::PackedDecoder> packedDecoders = {
+        {qMetaTypeId<FloatList>(), QProtobufSerializerPrivate::appendPacked<float>},
+        {qMetaTypeId<DoubleList>(), QProtobufSerializerPrivate::appendPacked<double>},
+        {qMetaTypeId<fixed32List>(), QProtobufSerializerPrivate::appendPacked<fixed32>},
+        {qMetaTypeId<fixed64List>(), QProtobufSerializerPrivate::appendPacked<fixed64>},
+        {qMetaTypeId<sfixed32List>(), QProtobufSerializerPrivate::appendPacked<sfixed32>},
+        {qMetaTypeId<sfixed64List>(), QProtobufSerializerPrivate::appendPacked<sfixed64>},
+        {qMetaTypeId<int32List>(), QProtobufSerializerPrivate::appendPacked<int32>},
+        {qMetaTypeId<int64List>(), QProtobufSerializerPrivate::appendPacked<int64>},
+        {qMetaTypeId<sint32List>(), QProtobufSerializerPrivate::appendPacked<sint32>},
+        {qMetaTypeId<sint64List>(), QProtobufSerializerPrivate::appendPacked<sint64>},
+        {qMetaTypeId<uint32List>(), QProtobufSerializerPrivate::appendPacked<uint32>},
+        {qMetaTypeId<uint64List>(), QProtobufSerializerPrivate::appendPacked<uint64>}
+    };
+    auto it = packedDecoders.find(userType);
+    return it != packedDecoders.end() ? it->second : nullptr;
+}
 
-    QByteArrayList list = previousValue.value<QByteArrayList>();
-    list.append(deserializeLengthDelimited(it));
-    previousValue.setValue(list);
+//! \private XXH64 primes used by content hash
+constexpr quint64 HashPrime1 = 11400714785074694791ULL;
+constexpr quint64 HashPrime2 = 14029467366897019727ULL;
+constexpr quint64 HashPrime3 = 1609587929392839161ULL;
+constexpr quint64 HashPrime4 = 9650029242287828579ULL;
+constexpr quint64 HashPrime5 = 2870177450012600261ULL;
+
+inline quint64 rotateLeft(quint64 value, int bits)
+{
+    return (value << bits) | (value >> (64 - bits));
 }
 
-template<>
-void QProtobufSerializerPrivate::deserializeList<QString>(QProtobufSelfcheckIterator &it, QVariant &previousValue)
+inline quint64 hashRound(quint64 accumulator, quint64 input)
+{
+    accumulator += input * HashPrime2;
+    accumulator = rotateLeft(accumulator, 31);
+    return accumulator * HashPrime1;
+}
+
+inline quint64 hashMergeRound(quint64 accumulator, quint64 value)
+{
+    accumulator ^= hashRound(0, value);
+    return accumulator * HashPrime1 + HashPrime4;
+}
+
+//! \private Mask of high bits of UTF-16 code units in 64-bit word, any of them is set if word contains non-ASCII code unit
+constexpr quint64 NonAsciiUtf16Mask = 0xff80ff80ff80ff80ULL;
+
+/*!
+ * \private
+ * \brief Returns number of leading ASCII code units in UTF-16 \a data
+ */
+qsizetype asciiPrefixLength(const char16_t *data, qsizetype size)
+{
+    qsizetype i = 0;
+#ifdef QT_PROTOBUF_UTF8_SSE2
+    const __m128i nonAsciiBits = _mm_set1_epi16(static_cast<short>(0xff80));
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 8 <= size; i += 8) {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+        const uint mask = static_cast<uint>(_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(chunk, nonAsciiBits), zero)));
+        if (mask != 0xffff) {
+            //Each code unit is represented by two bits of mask
+            return i + qCountTrailingZeroBits(~mask & 0xffff) / 2;
+        }
+    }
+#endif
+    for (; i + 4 <= size; i += 4) {
+        quint64 word;
+        std::memcpy(&word, data + i, sizeof(word));
+        if ((word & NonAsciiUtf16Mask) != 0) {
+            break;
+        }
+    }
+    for (; i < size && data[i] < 0x80; ++i) {}
+    return i;
+}
+
+/*!
+ * \private
+ * \brief Narrows ASCII UTF-16 \a data to UTF-8 \a out
+ */
+void narrowAscii(const char16_t *data, qsizetype size, uchar *out)
+{
+    qsizetype i = 0;
+#ifdef QT_PROTOBUF_UTF8_SSE2
+    for (; i + 16 <= size; i += 16) {
+        const __m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+        const __m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i + 8));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), _mm_packus_epi16(low, high));
+    }
+#endif
+    for (; i < size; ++i) {
+        out[i] = static_cast<uchar>(data[i]);
+    }
+}
+
+/*!
+ * \private
+ * \brief The SerializationContext class holds state of the two-pass serialization
+ *
+ * \details During the measuring pass sizes of nested messages and map pairs are stored in pre-order.
+ *          The writing pass consumes them in the same order. Context is installed per thread for the
+ *          lifetime of object, so serializeObject/serializeListObject/serializeMapPair calls made by
+ *          registered handlers join the serialization that is in progress instead of producing
+ *          intermediate byte arrays. QByteArray-returning variants of these methods return empty
+ *          array in measuring pass.
+ */
+class SerializationContext
+{
+    Q_DISABLE_COPY_MOVE(SerializationContext)
+public:
+    SerializationContext() : m_previous(s_current) {
+        s_current = this;
+    }
+    ~SerializationContext() {
+        s_current = m_previous;
+    }
+
+    static SerializationContext *current() {
+        return s_current;
+    }
+
+    bool isMeasuring() const {
+        return m_buffer == nullptr;
+    }
+
+    void beginWrite(QByteArray *buffer, QIODevice *device = nullptr) {
+        m_buffer = buffer;
+        m_device = device;
+        m_cursor = 0;
+    }
+
+    /*!
+     * \brief Writes content of context buffer to the device, if device is assigned and buffer is
+     *        large enough or \a force is set. Buffers other than context buffer are not flushed.
+     * \return false if writing to device failed at any time
+     */
+    bool flush(QByteArray &out, bool force = false) {
+        if (m_device == nullptr || &out != m_buffer
+                || (!force && out.size() < StreamChunkSize)) {
+            return !m_deviceError;
+        }
+
+        if (!m_deviceError && m_device->write(out) != out.size()) {
+            m_deviceError = true;
+        }
+        //Keep allocated capacity for the next chunk
+        out.resize(0);
+        return !m_deviceError;
+    }
+
+    QByteArray *buffer() const {
+        return m_buffer;
+    }
+
+    std::size_t reserveSize() {
+        m_sizes.push_back(0);
+        return m_sizes.size() - 1;
+    }
+
+    void setSize(std::size_t slot, qsizetype size) {
+        m_sizes[slot] = size;
+    }
+
+    qsizetype nextSize() {
+        Q_ASSERT_X(m_cursor < m_sizes.size(), "SerializationContext", "Serialized data doesn't match measured data");
+        return m_sizes[m_cursor++];
+    }
+
+    qsizetype measured() const {
+        return m_measured;
+    }
+
+    void setMeasured(qsizetype measured) {
+        m_measured = measured;
+    }
+
+    void addMeasured(qsizetype size) {
+        m_measured += size;
+    }
+
+private:
+    SerializationContext *m_previous;
+    QByteArray *m_buffer = nullptr;
+    QIODevice *m_device = nullptr;
+    bool m_deviceError = false;
+    std::vector<qsizetype> m_sizes;
+    std::size_t m_cursor = 0;
+    qsizetype m_measured = 0;
+    static thread_local SerializationContext *s_current;
+};
+
+thread_local SerializationContext *SerializationContext::s_current = nullptr;
+
+/*!
+ * \private
+ * \brief Serializes unit of data either as part of serialization that is in progress or standalone
+ *
+ * \details If there is active serialization context, the size of unit is accumulated in measuring pass and
+ *          nothing is appended to \a out, or unit is appended to \a out in writing pass. Otherwise unit is
+ *          appended to \a out that is reserved for its exact size.
+ */
+template <typename SizeFunction, typename WriteFunction>
+void serializeUnit(SizeFunction sizeFunction, WriteFunction writeFunction, QByteArray &out)
 {
-    qProtoDebug() << __func__ << "currentByte:" << QString::number((*it), 16);
+    SerializationContext *context = SerializationContext::current();
+    if (context == nullptr) {
+        SerializationContext localContext;
+        out.reserve(out.size() + sizeFunction());
+        localContext.beginWrite(&out);
+        writeFunction(out);
+        return;
+    }
 
-    QStringList list = previousValue.value<QStringList>();
-    QByteArray value = deserializeLengthDelimited(it);
-    list.append(QString::fromUtf8(value));
-    previousValue.setValue(list);
+    if (context->isMeasuring()) {
+        context->addMeasured(sizeFunction());
+    } else {
+        writeFunction(out);
+    }
+}
 }
 
 QProtobufSerializer::~QProtobufSerializer() = default;
 
-QProtobufSerializer::QProtobufSerializer() : dPtr(new QProtobufSerializerPrivate(this))
+QProtobufSerializer::QProtobufSerializer(DefaultValuesMode mode) : dPtr(new QProtobufSerializerPrivate(this, mode == ElideDefaultValues))
 {
 }
 
-QByteArray QProtobufSerializer::serializeMessage(const QObject *object, const QProtobufMetaObject &metaObject) const
+bool QProtobufSerializer::supportsDirectWriting() const
 {
-    QByteArray result;
-    for (const auto &field : metaObject.propertyOrdering) {
-        int propertyIndex = field.second;
-        int fieldIndex = field.first;
-        Q_ASSERT_X(fieldIndex < 536870912 && fieldIndex > 0, "", "fieldIndex is out of range");
-        QMetaProperty metaProperty = metaObject.staticMetaObject.property(propertyIndex);
-        const char *propertyName = metaProperty.name();
-        QVariant propertyValue = object->property(propertyName);
-        result.append(dPtr->serializeProperty(propertyValue, QProtobufMetaProperty(metaProperty,
-                                                                                   fieldIndex,
-                                                                                   field.second)));
+    //Generated serializeTo methods always skip default values
+    return dPtr->defaultValuesElided;
+}
+
+bool QProtobufSerializer::defaultValuesElided() const
+{
+    return dPtr->defaultValuesElided;
+}
+
+quint64 QProtobufSerializer::contentHash(const QByteArray &data, quint64 seed)
+{
+    const uchar *it = reinterpret_cast<const uchar *>(data.constData());
+    const uchar *end = it + data.size();
+
+    quint64 hash = 0;
+    if (data.size() >= 32) {
+        const uchar *limit = end - 32;
+        quint64 v1 = seed + HashPrime1 + HashPrime2;
+        quint64 v2 = seed + HashPrime2;
+        quint64 v3 = seed;
+        quint64 v4 = seed - HashPrime1;
+        do {
+            v1 = hashRound(v1, qFromLittleEndian<quint64>(it));
+            v2 = hashRound(v2, qFromLittleEndian<quint64>(it + 8));
+            v3 = hashRound(v3, qFromLittleEndian<quint64>(it + 16));
+            v4 = hashRound(v4, qFromLittleEndian<quint64>(it + 24));
+            it += 32;
+        } while (it <= limit);
+
+        hash = rotateLeft(v1, 1) + rotateLeft(v2, 7) + rotateLeft(v3, 12) + rotateLeft(v4, 18);
+        hash = hashMergeRound(hash, v1);
+        hash = hashMergeRound(hash, v2);
+        hash = hashMergeRound(hash, v3);
+        hash = hashMergeRound(hash, v4);
+    } else {
+        hash = seed + HashPrime5;
     }
 
+    hash += static_cast<quint64>(data.size());
+
+    for (; end - it >= 8; it += 8) {
+        hash ^= hashRound(0, qFromLittleEndian<quint64>(it));
+        hash = rotateLeft(hash, 27) * HashPrime1 + HashPrime4;
+    }
+
+    if (end - it >= 4) {
+        hash ^= static_cast<quint64>(qFromLittleEndian<quint32>(it)) * HashPrime1;
+        hash = rotateLeft(hash, 23) * HashPrime2 + HashPrime3;
+        it += 4;
+    }
+
+    for (; it != end; ++it) {
+        hash ^= static_cast<quint64>(*it) * HashPrime5;
+        hash = rotateLeft(hash, 11) * HashPrime1;
+    }
+
+    hash ^= hash >> 33;
+    hash *= HashPrime2;
+    hash ^= hash >> 29;
+    hash *= HashPrime3;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+QByteArray QProtobufSerializer::serializeMessage(const QObject *object, const QProtobufMetaObject &metaObject) const
+{
+    QByteArray result;
+    serializeMessage(object, metaObject, result);
     return result;
 }
 
+void QProtobufSerializer::serializeMessage(const QObject *object, const QProtobufMetaObject &metaObject, QByteArray &out) const
+{
+    dPtr->serializeMessage(object, metaObject, out);
+}
+
+bool QProtobufSerializer::serializeMessage(const QObject *object, const QProtobufMetaObject &metaObject, QIODevice *device) const
+{
+    return dPtr->serializeMessage(object, metaObject, device);
+}
+
 void QProtobufSerializer::deserializeMessage(QObject *object, const QProtobufMetaObject &metaObject, const QByteArray &data) const
 {
-    for (QProtobufSelfcheckIterator it(data); it != data.end();) {
-        dPtr->deserializeProperty(object, metaObject, it);
-    }
+    QProtobufSelfcheckIterator it(data);
+    dPtr->deserializeMessage(object, metaObject, it);
+}
+
+QProtobufDecodeResult QProtobufSerializer::validateMessage(const QProtobufMetaObject &metaObject, const QByteArray &data) const
+{
+    const char *begin = data.constData();
+    return QProtobufSerializerPrivate::validateMessage(begin, begin, begin + data.size(), &metaObject, nullptr, 0);
 }
 
 QByteArray QProtobufSerializer::serializeObject(const QObject *object, const QProtobufMetaObject &metaObject, const QProtobufMetaProperty &metaProperty) const
 {
-    QByteArray result = QProtobufSerializerPrivate::encodeHeader(metaProperty.protoFieldIndex(), LengthDelimited);
-    result.append(QProtobufSerializerPrivate::prependLengthDelimitedSize(serializeMessage(object, metaObject)));
+    QByteArray result;
+    serializeObject(object, metaObject, metaProperty, result);
     return result;
 }
 
+void QProtobufSerializer::serializeObject(const QObject *object, const QProtobufMetaObject &metaObject, const QProtobufMetaProperty &metaProperty, QByteArray &out) const
+{
+    dPtr->serializeObject(object, metaObject, metaProperty, out);
+}
+
 void QProtobufSerializer::deserializeObject(QObject *object, const QProtobufMetaObject &metaObject, QProtobufSelfcheckIterator &it) const
 {
-    QByteArray array = QProtobufSerializerPrivate::deserializeLengthDelimited(it);
-    deserializeMessage(object, metaObject, array);
+    //Nested message is parsed in place, within bounds of its length-delimited data
+    QProtobufSelfcheckIterator nestedIt = QProtobufSerializerPrivate::deserializeLengthDelimitedView(it);
+    dPtr->deserializeMessage(object, metaObject, nestedIt);
 }
 
 QByteArray QProtobufSerializer::serializeListObject(const QObject *object, const QProtobufMetaObject &metaObject, const QProtobufMetaProperty &metaProperty) const
@@ -121,6 +459,11 @@ QByteArray QProtobufSerializer::serializeListObject(const QObject *object, const
     return serializeObject(object, metaObject, metaProperty);
 }
 
+void QProtobufSerializer::serializeListObject(const QObject *object, const QProtobufMetaObject &metaObject, const QProtobufMetaProperty &metaProperty, QByteArray &out) const
+{
+    serializeObject(object, metaObject, metaProperty, out);
+}
+
 bool QProtobufSerializer::deserializeListObject(QObject *object, const QProtobufMetaObject &metaObject, QProtobufSelfcheckIterator &it) const
 {
     deserializeObject(object, metaObject, it);
@@ -129,41 +472,46 @@ bool QProtobufSerializer::deserializeListObject(QObject *object, const QProtobuf
 
 QByteArray QProtobufSerializer::serializeMapPair(const QVariant &key, const QVariant &value, const QProtobufMetaProperty &metaProperty) const
 {
-    QByteArray result = QProtobufSerializerPrivate::encodeHeader(metaProperty.protoFieldIndex(), LengthDelimited);
-    result.append(QProtobufSerializerPrivate::prependLengthDelimitedSize(
-                      dPtr->serializeProperty(key, QProtobufMetaProperty(metaProperty, 1, QString())) +
-                      dPtr->serializeProperty(value, QProtobufMetaProperty(metaProperty, 2, QString()))));
+    QByteArray result;
+    serializeMapPair(key, value, metaProperty, result);
     return result;
 }
 
+void QProtobufSerializer::serializeMapPair(const QVariant &key, const QVariant &value, const QProtobufMetaProperty &metaProperty, QByteArray &out) const
+{
+    dPtr->serializeMapPair(key, value, metaProperty, out);
+}
+
 bool QProtobufSerializer::deserializeMapPair(QVariant &key, QVariant &value, QProtobufSelfcheckIterator &it) const
 {
     dPtr->deserializeMapPair(key, value, it);
     return true;
 }
 
-QByteArray QProtobufSerializer::serializeEnum(int64 value, const QMetaEnum &/*metaEnum*/, const QtProtobuf::QProtobufMetaProperty &metaProperty) const
+QByteArray QProtobufSerializer::serializeEnum(int64 value, const QMetaEnum &metaEnum, const QtProtobuf::QProtobufMetaProperty &metaProperty) const
 {
-    WireTypes type = Varint;
-    int fieldIndex = metaProperty.protoFieldIndex();
-    QByteArray result = QProtobufSerializerPrivate::serializeBasic<int64>(value, fieldIndex);
-    if (fieldIndex != QtProtobufPrivate::NotUsedFieldIndex) {
-        result.prepend(QProtobufSerializerPrivate::encodeHeader(metaProperty.protoFieldIndex(), type));
-    }
+    QByteArray result;
+    serializeEnum(value, metaEnum, metaProperty, result);
     return result;
 }
 
-QByteArray QProtobufSerializer::serializeEnumList(const QList<int64> &value, const QMetaEnum &/*metaEnum*/, const QtProtobuf::QProtobufMetaProperty &metaProperty) const
+QByteArray QProtobufSerializer::serializeEnumList(const QList<int64> &value, const QMetaEnum &metaEnum, const QtProtobuf::QProtobufMetaProperty &metaProperty) const
 {
-    WireTypes type = LengthDelimited;
-    int fieldIndex = metaProperty.protoFieldIndex();
-    QByteArray result = QProtobufSerializerPrivate::serializeListType<int64>(value, fieldIndex);
-    if (fieldIndex != QtProtobufPrivate::NotUsedFieldIndex) {
-        result.prepend(QProtobufSerializerPrivate::encodeHeader(metaProperty.protoFieldIndex(), type));
-    }
+    QByteArray result;
+    serializeEnumList(value, metaEnum, metaProperty, result);
     return result;
 }
 
+void QProtobufSerializer::serializeEnum(int64 value, const QMetaEnum &/*metaEnum*/, const QtProtobuf::QProtobufMetaProperty &metaProperty, QByteArray &out) const
+{
+    dPtr->serializeProperty(QVariant::fromValue(value), metaProperty, out);
+}
+
+void QProtobufSerializer::serializeEnumList(const QList<int64> &value, const QMetaEnum &/*metaEnum*/, const QtProtobuf::QProtobufMetaProperty &metaProperty, QByteArray &out) const
+{
+    dPtr->serializeProperty(QVariant::fromValue(value), metaProperty, out);
+}
+
 void QProtobufSerializer::deserializeEnum(int64 &value, const QMetaEnum &/*metaEnum*/, QProtobufSelfcheckIterator &it) const
 {
     QVariant variantValue;
@@ -178,49 +526,52 @@ void QProtobufSerializer::deserializeEnumList(QList<int64> &value, const QMetaEn
     value = variantValue.value<QList<int64>>();
 }
 
-QProtobufSerializerPrivate::QProtobufSerializerPrivate(QProtobufSerializer *q) : q_ptr(q)
-{
-    //if handlers is not empty intialization already done
-    if (handlers.empty()) {
-        wrapSerializer<float, serializeBasic, deserializeBasic<float>, Fixed32>();
-        wrapSerializer<double, serializeBasic, deserializeBasic<double>, Fixed64>();
-        wrapSerializer<int32, serializeBasic, deserializeBasic<int32>, Varint>();
-        wrapSerializer<int64, serializeBasic, deserializeBasic<int64>, Varint>();
-        wrapSerializer<uint32, serializeBasic, deserializeBasic<uint32>, Varint>();
-        wrapSerializer<uint64, serializeBasic, deserializeBasic<uint64>, Varint>();
-        wrapSerializer<sint32, serializeBasic, deserializeBasic<sint32>, Varint>();
-        wrapSerializer<sint64, serializeBasic, deserializeBasic<sint64>, Varint>();
-        wrapSerializer<fixed32, serializeBasic, deserializeBasic<fixed32>, Fixed32>();
-        wrapSerializer<fixed64, serializeBasic, deserializeBasic<fixed64>, Fixed64>();
-        wrapSerializer<sfixed32, serializeBasic, deserializeBasic<sfixed32>, Fixed32>();
-        wrapSerializer<sfixed64, serializeBasic, deserializeBasic<sfixed64>, Fixed64>();
-        wrapSerializer<bool, uint32, serializeBasic<uint32>, deserializeBasic<uint32>, Varint>();
-        wrapSerializer<QString, serializeBasic, deserializeBasic<QString>, LengthDelimited>();
-        wrapSerializer<QByteArray, serializeBasic, deserializeBasic<QByteArray>, LengthDelimited>();
-
-        wrapSerializer<FloatList, serializeListType, deserializeList<float>, LengthDelimited>();
-        wrapSerializer<DoubleList, serializeListType, deserializeList<double>, LengthDelimited>();
-        wrapSerializer<fixed32List, serializeListType, deserializeList<fixed32>, LengthDelimited>();
-        wrapSerializer<fixed64List, serializeListType, deserializeList<fixed64>, LengthDelimited>();
-        wrapSerializer<sfixed32List, serializeListType, deserializeList<sfixed32>, LengthDelimited>();
-        wrapSerializer<sfixed64List, serializeListType, deserializeList<sfixed64>, LengthDelimited>();
-        wrapSerializer<int32List, serializeListType, deserializeList<int32>, LengthDelimited>();
-        wrapSerializer<int64List, serializeListType, deserializeList<int64>, LengthDelimited>();
-        wrapSerializer<sint32List, serializeListType, deserializeList<sint32>, LengthDelimited>();
-        wrapSerializer<sint64List, serializeListType, deserializeList<sint64>, LengthDelimited>();
-        wrapSerializer<uint32List, serializeListType, deserializeList<uint32>, LengthDelimited>();
-        wrapSerializer<uint64List, serializeListType, deserializeList<uint64>, LengthDelimited>();
-        wrapSerializer<QStringList, QStringList, serializeListType<QString>, deserializeList<QString>, LengthDelimited>();
-        wrapSerializer<QByteArrayList, serializeListType, deserializeList<QByteArray>, LengthDelimited>();
-    }
+QProtobufSerializerPrivate::QProtobufSerializerPrivate(QProtobufSerializer *q, bool elideDefaultValues) :
+    defaultValuesElided(elideDefaultValues)
+  , q_ptr(q)
+{
+    //Basic type handlers are registered once. Initialization of function-local static is thread-safe
+    static const bool handlersInitialized = [] {
+        wrapSerializer<float, sizeBasic, writeBasic, deserializeBasic<float>, Fixed32>();
+        wrapSerializer<double, sizeBasic, writeBasic, deserializeBasic<double>, Fixed64>();
+        wrapSerializer<int32, sizeBasic, writeBasic, deserializeBasic<int32>, Varint>();
+        wrapSerializer<int64, sizeBasic, writeBasic, deserializeBasic<int64>, Varint>();
+        wrapSerializer<uint32, sizeBasic, writeBasic, deserializeBasic<uint32>, Varint>();
+        wrapSerializer<uint64, sizeBasic, writeBasic, deserializeBasic<uint64>, Varint>();
+        wrapSerializer<sint32, sizeBasic, writeBasic, deserializeBasic<sint32>, Varint>();
+        wrapSerializer<sint64, sizeBasic, writeBasic, deserializeBasic<sint64>, Varint>();
+        wrapSerializer<fixed32, sizeBasic, writeBasic, deserializeBasic<fixed32>, Fixed32>();
+        wrapSerializer<fixed64, sizeBasic, writeBasic, deserializeBasic<fixed64>, Fixed64>();
+        wrapSerializer<sfixed32, sizeBasic, writeBasic, deserializeBasic<sfixed32>, Fixed32>();
+        wrapSerializer<sfixed64, sizeBasic, writeBasic, deserializeBasic<sfixed64>, Fixed64>();
+        wrapSerializer<bool, uint32, sizeBasic<uint32>, writeBasic<uint32>, deserializeBasic<uint32>, Varint>();
+        wrapSerializer<QString, sizeBasic, writeBasic, deserializeBasic<QString>, LengthDelimited>();
+        wrapSerializer<QByteArray, sizeBasic, writeBasic, deserializeBasic<QByteArray>, LengthDelimited>();
+
+        wrapSerializer<FloatList, sizeListType, writeListType, deserializeList<float>, LengthDelimited>();
+        wrapSerializer<DoubleList, sizeListType, writeListType, deserializeList<double>, LengthDelimited>();
+        wrapSerializer<fixed32List, sizeListType, writeListType, deserializeList<fixed32>, LengthDelimited>();
+        wrapSerializer<fixed64List, sizeListType, writeListType, deserializeList<fixed64>, LengthDelimited>();
+        wrapSerializer<sfixed32List, sizeListType, writeListType, deserializeList<sfixed32>, LengthDelimited>();
+        wrapSerializer<sfixed64List, sizeListType, writeListType, deserializeList<sfixed64>, LengthDelimited>();
+        wrapSerializer<int32List, sizeListType, writeListType, deserializeList<int32>, LengthDelimited>();
+        wrapSerializer<int64List, sizeListType, writeListType, deserializeList<int64>, LengthDelimited>();
+        wrapSerializer<sint32List, sizeListType, writeListType, deserializeList<sint32>, LengthDelimited>();
+        wrapSerializer<sint64List, sizeListType, writeListType, deserializeList<sint64>, LengthDelimited>();
+        wrapSerializer<uint32List, sizeListType, writeListType, deserializeList<uint32>, LengthDelimited>();
+        wrapSerializer<uint64List, sizeListType, writeListType, deserializeList<uint64>, LengthDelimited>();
+        wrapSerializer<QStringList, sizeListType, writeListType, deserializeList<QString>, LengthDelimited>();
+        wrapSerializer<QByteArrayList, sizeListType, writeListType, deserializeList<QByteArray>, LengthDelimited>();
+        return true;
+    }();
+    Q_UNUSED(handlersInitialized)
 }
 
 void QProtobufSerializerPrivate::skipVarint(QProtobufSelfcheckIterator &it)
 {
-    while ((*it) & 0x80) {
-        ++it;
-    }
-    ++it;
+    uint64_t value = 0;
+    const char *begin = it.data();
+    it += static_cast<int>(QProtobufPackedCodec::readVarint(begin, begin + it.size(), value) - begin);
 }
 
 void QProtobufSerializerPrivate::skipLengthDelimited(QProtobufSelfcheckIterator &it)
@@ -255,36 +606,342 @@ int QProtobufSerializerPrivate::skipSerializedFieldBytes(QProtobufSelfcheckItera
 }
 
 
-QByteArray QProtobufSerializerPrivate::serializeProperty(const QVariant &propertyValue, const QProtobufMetaProperty &metaProperty)
+qsizetype QProtobufSerializerPrivate::utf8Size(const QString &value)
 {
-    qProtoDebug() << __func__ << "propertyValue" << propertyValue << "fieldIndex" << metaProperty.protoFieldIndex()
-                  << static_cast<QMetaType::Type>(propertyValue.type());
+    const char16_t *it = reinterpret_cast<const char16_t *>(value.constData());
+    const char16_t *end = it + value.size();
+    qsizetype size = 0;
+    while (it != end) {
+        const qsizetype asciiSize = asciiPrefixLength(it, end - it);
+        size += asciiSize;
+        it += asciiSize;
+        if (it == end) {
+            break;
+        }
 
-    QByteArray result;
-    WireTypes type = UnknownWireType;
+        const char16_t c = *it++;
+        if (c < 0x800) {
+            size += 2;
+        } else if (QChar::isSurrogate(c)) {
+            if (QChar::isHighSurrogate(c) && it != end && QChar::isLowSurrogate(*it)) {
+                size += 4;
+                ++it;
+            } else {
+                //Unpaired surrogate is replaced by '?' same way as QString::toUtf8 does
+                size += 1;
+            }
+        } else {
+            size += 3;
+        }
+    }
+    return size;
+}
+
+void QProtobufSerializerPrivate::writeLengthDelimited(const QString &value, QByteArray &out)
+{
+    qProtoDebug() << __func__ << "value" << value;
+
+    const qsizetype size = utf8Size(value);
+    writeVarint(static_cast<uint32_t>(size), out);
+
+    const qsizetype offset = out.size();
+    out.resize(offset + size);
+    uchar *dst = reinterpret_cast<uchar *>(out.data() + offset);
+
+    //Encode UTF-16 directly to the output buffer to avoid intermediate QByteArray
+    const char16_t *it = reinterpret_cast<const char16_t *>(value.constData());
+    const char16_t *end = it + value.size();
+    while (it != end) {
+        const qsizetype asciiSize = asciiPrefixLength(it, end - it);
+        narrowAscii(it, asciiSize, dst);
+        dst += asciiSize;
+        it += asciiSize;
+        if (it == end) {
+            break;
+        }
+
+        const char16_t c = *it++;
+        if (c < 0x800) {
+            *dst++ = static_cast<uchar>(0xc0 | (c >> 6));
+            *dst++ = static_cast<uchar>(0x80 | (c & 0x3f));
+        } else if (QChar::isSurrogate(c)) {
+            if (QChar::isHighSurrogate(c) && it != end && QChar::isLowSurrogate(*it)) {
+                const uint ucs4 = QChar::surrogateToUcs4(c, *it++);
+                *dst++ = static_cast<uchar>(0xf0 | (ucs4 >> 18));
+                *dst++ = static_cast<uchar>(0x80 | ((ucs4 >> 12) & 0x3f));
+                *dst++ = static_cast<uchar>(0x80 | ((ucs4 >> 6) & 0x3f));
+                *dst++ = static_cast<uchar>(0x80 | (ucs4 & 0x3f));
+            } else {
+                *dst++ = '?';
+            }
+        } else {
+            *dst++ = static_cast<uchar>(0xe0 | (c >> 12));
+            *dst++ = static_cast<uchar>(0x80 | ((c >> 6) & 0x3f));
+            *dst++ = static_cast<uchar>(0x80 | (c & 0x3f));
+        }
+    }
+    Q_ASSERT(dst == reinterpret_cast<uchar *>(out.data() + out.size()));
+}
+
+void QProtobufSerializerPrivate::serializeMessage(const QObject *object, const QProtobufMetaObject &metaObject, QByteArray &out,
+                                                  bool delimited)
+{
+    //Top-level message is always serialized in own context, even if it's requested by handler
+    SerializationContext context;
+    const qsizetype size = messageSize(object, metaObject);
+
+    if (delimited) {
+        out.reserve(out.size() + varintSize(static_cast<uint32_t>(size)) + size);
+        writeVarint(static_cast<uint32_t>(size), out);
+    }
+    const qsizetype offset = out.size();
+
+    out.reserve(offset + size);
+    context.beginWrite(&out);
+    context.nextSize();
+    writeMessage(object, metaObject, out);
+
+    Q_ASSERT_X(out.size() - offset == size, "QProtobufSerializer", "Serialized message size doesn't match precomputed size");
+}
+
+bool QProtobufSerializerPrivate::serializeMessage(const QObject *object, const QProtobufMetaObject &metaObject, QIODevice *device)
+{
+    Q_ASSERT_X(device != nullptr, "QProtobufSerializer", "Device is null");
+    SerializationContext context;
+    const qsizetype size = messageSize(object, metaObject);
+
+    //Message is written to device by chunks at field boundaries, so it is never stored in memory completely
+    QByteArray buffer;
+    buffer.reserve(qMin(size, StreamChunkSize * 2));
+    context.beginWrite(&buffer, device);
+    context.nextSize();
+    writeMessage(object, metaObject, buffer);
+    return context.flush(buffer, true);
+}
+
+void QProtobufSerializerPrivate::serializeObject(const QObject *object, const QProtobufMetaObject &metaObject, const QProtobufMetaProperty &metaProperty, QByteArray &out)
+{
+    const int fieldIndex = metaProperty.protoFieldIndex();
+    serializeUnit([&]() {
+        const qsizetype size = messageSize(object, metaObject);
+        return headerSize(fieldIndex, LengthDelimited) + varintSize(static_cast<uint32_t>(size)) + size;
+    }, [&](QByteArray &buffer) {
+        writeHeader(fieldIndex, LengthDelimited, buffer);
+        writeVarint(static_cast<uint32_t>(SerializationContext::current()->nextSize()), buffer);
+        writeMessage(object, metaObject, buffer);
+    }, out);
+}
+
+void QProtobufSerializerPrivate::serializeMapPair(const QVariant &key, const QVariant &value, const QProtobufMetaProperty &metaProperty, QByteArray &out)
+{
+    const int fieldIndex = metaProperty.protoFieldIndex();
+    serializeUnit([&]() {
+        SerializationContext *context = SerializationContext::current();
+        const std::size_t slot = context->reserveSize();
+        //Default key and value are written, same as protobuf reference implementation does
+        const qsizetype size = propertySize(key, QProtobufMetaProperty(metaProperty, 1, QString()), false)
+                + propertySize(value, QProtobufMetaProperty(metaProperty, 2, QString()), false);
+        context->setSize(slot, size);
+        return headerSize(fieldIndex, LengthDelimited) + varintSize(static_cast<uint32_t>(size)) + size;
+    }, [&](QByteArray &buffer) {
+        writeHeader(fieldIndex, LengthDelimited, buffer);
+        writeVarint(static_cast<uint32_t>(SerializationContext::current()->nextSize()), buffer);
+        writeProperty(key, QProtobufMetaProperty(metaProperty, 1, QString()), buffer, false);
+        writeProperty(value, QProtobufMetaProperty(metaProperty, 2, QString()), buffer, false);
+    }, out);
+}
+
+void QProtobufSerializerPrivate::serializeProperty(const QVariant &propertyValue, const QProtobufMetaProperty &metaProperty, QByteArray &out)
+{
+    serializeUnit([&]() {
+        return propertySize(propertyValue, metaProperty);
+    }, [&](QByteArray &buffer) {
+        writeProperty(propertyValue, metaProperty, buffer);
+    }, out);
+}
+
+qsizetype QProtobufSerializerPrivate::messageSize(const QObject *object, const QProtobufMetaObject &metaObject)
+{
+    SerializationContext *context = SerializationContext::current();
+    const std::size_t slot = context->reserveSize();
+
+    qsizetype size = 0;
+    for (const auto &field : metaObject.dispatchTable().fields()) {
+        Q_ASSERT_X(field.fieldNumber < 536870912 && field.fieldNumber > 0, "", "fieldIndex is out of range");
+        size += propertySize(field.metaProperty->read(object), field);
+    }
+
+    const QProtobufUnknownFields *unknownFields = metaObject.unknownFields(object);
+    if (unknownFields != nullptr) {
+        size += unknownFields->size();
+    }
+
+    context->setSize(slot, size);
+    return size;
+}
+
+void QProtobufSerializerPrivate::writeMessage(const QObject *object, const QProtobufMetaObject &metaObject, QByteArray &out)
+{
+    //Fields are written in ascending field number order, so equal messages are always serialized to equal bytes
+    SerializationContext *context = SerializationContext::current();
+    for (const auto &field : metaObject.dispatchTable().fields()) {
+        writeProperty(field.metaProperty->read(object), field, out);
+        context->flush(out);
+    }
+
+    //Unknown fields are appended as is, after known fields
+    const QProtobufUnknownFields *unknownFields = metaObject.unknownFields(object);
+    if (unknownFields != nullptr && !unknownFields->isEmpty()) {
+        unknownFields->serializeTo(out);
+        context->flush(out);
+    }
+}
+
+qsizetype QProtobufSerializerPrivate::propertySize(const QVariant &propertyValue, const QProtobufMetaProperty &metaProperty,
+                                                   bool elideDefaults)
+{
+    auto basicIt = handlers.find(propertyValue.userType());
+    return propertySize(propertyValue, metaProperty, basicIt != handlers.end() ? &(basicIt->second) : nullptr, nullptr,
+                        elideDefaults);
+}
+
+qsizetype QProtobufSerializerPrivate::propertySize(const QVariant &propertyValue, const FieldDispatchEntry &field)
+{
+    if (propertyValue.userType() != field.userType) {
+        return propertySize(propertyValue, *field.metaProperty);
+    }
+    return propertySize(propertyValue, *field.metaProperty, field.basicHandlers, field.handler, true);
+}
+
+qsizetype QProtobufSerializerPrivate::propertySize(const QVariant &propertyValue, const QProtobufMetaProperty &metaProperty,
+                                                   const SerializationHandlers *basicHandlers,
+                                                   const QtProtobufPrivate::SerializationHandler *handler,
+                                                   bool elideDefaults)
+{
+    int fieldIndex = metaProperty.protoFieldIndex();
+    if (basicHandlers != nullptr) {
+        if (elideDefaults && defaultValuesElided && basicHandlers->isDefault(propertyValue)) {
+            return 0;
+        }
+        qsizetype size = basicHandlers->sizeCalculator(propertyValue, fieldIndex);
+        if (fieldIndex != QtProtobufPrivate::NotUsedFieldIndex
+                && basicHandlers->type != UnknownWireType) {
+            size += headerSize(metaProperty.protoFieldIndex(), basicHandlers->type);
+        }
+        return size;
+    }
+
+    //Registered handlers call serializeObject/serializeListObject/serializeMapPair that only accumulate
+    //size in measuring pass. Handlers also may append data to the buffer directly, this data is counted too.
+    SerializationContext *context = SerializationContext::current();
+    const qsizetype previousMeasured = context->measured();
+    context->setMeasured(0);
+
+    QByteArray handlerData;
+    if (handler == nullptr) {
+        handler = &QtProtobufPrivate::findHandler(propertyValue.userType());
+    }
+    handler->serializer(q_ptr, propertyValue, metaProperty, handlerData);
+
+    const qsizetype size = context->measured() + handlerData.size();
+    context->setMeasured(previousMeasured);
+    return size;
+}
+
+void QProtobufSerializerPrivate::writeProperty(const QVariant &propertyValue, const QProtobufMetaProperty &metaProperty, QByteArray &out,
+                                               bool elideDefaults)
+{
+    auto basicIt = handlers.find(propertyValue.userType());
+    writeProperty(propertyValue, metaProperty, basicIt != handlers.end() ? &(basicIt->second) : nullptr, nullptr, out,
+                  elideDefaults);
+}
 
-    int userType = propertyValue.userType();
+void QProtobufSerializerPrivate::writeProperty(const QVariant &propertyValue, const FieldDispatchEntry &field, QByteArray &out)
+{
+    if (propertyValue.userType() != field.userType) {
+        writeProperty(propertyValue, *field.metaProperty, out);
+        return;
+    }
+    writeProperty(propertyValue, *field.metaProperty, field.basicHandlers, field.handler, out, true);
+}
+
+void QProtobufSerializerPrivate::writeProperty(const QVariant &propertyValue, const QProtobufMetaProperty &metaProperty,
+                                               const SerializationHandlers *basicHandlers,
+                                               const QtProtobufPrivate::SerializationHandler *handler, QByteArray &out,
+                                               bool elideDefaults)
+{
+    qProtoDebug() << __func__ << "propertyValue" << propertyValue << "fieldIndex" << metaProperty.protoFieldIndex()
+                  << static_cast<QMetaType::Type>(propertyValue.type());
 
-    //TODO: replace with some common function
     int fieldIndex = metaProperty.protoFieldIndex();
-    auto basicIt = handlers.find(userType);
-    if (basicIt != handlers.end()) {
-        type = basicIt->second.type;
-        result.append(basicIt->second.serializer(propertyValue, fieldIndex));
+    if (basicHandlers != nullptr) {
+        if (elideDefaults && defaultValuesElided && basicHandlers->isDefault(propertyValue)) {
+            return;
+        }
+        const qsizetype size = basicHandlers->sizeCalculator(propertyValue, fieldIndex);
         if (fieldIndex != QtProtobufPrivate::NotUsedFieldIndex
-                && type != UnknownWireType) {
-            result.prepend(QProtobufSerializerPrivate::encodeHeader(metaProperty.protoFieldIndex(), type));
+                && basicHandlers->type != UnknownWireType) {
+            writeHeader(metaProperty.protoFieldIndex(), basicHandlers->type, out);
+        }
+        if (size > 0) {
+            basicHandlers->writer(propertyValue, metaProperty.protoFieldIndex(), out);
         }
     } else {
-        auto handler = QtProtobufPrivate::findHandler(userType);
-        handler.serializer(q_ptr, propertyValue, metaProperty, result);
+        if (handler == nullptr) {
+            handler = &QtProtobufPrivate::findHandler(propertyValue.userType());
+        }
+        handler->serializer(q_ptr, propertyValue, metaProperty, out);
     }
-    return result;
 }
 
-void QProtobufSerializerPrivate::deserializeProperty(QObject *object, const QProtobufMetaObject &metaObject, QProtobufSelfcheckIterator &it)
+QByteArray QProtobufSerializerPrivate::sharedData(const QByteArray *container, const char *data, int size)
+{
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+    //Result shares reference-counted data block with container, so it stays valid when container is
+    //destroyed and is detached on modification. Raw data and static arrays have no data block, so they are copied.
+    if (container != nullptr && container->data_ptr().d != nullptr && size > 0) {
+        Q_ASSERT(data >= container->constData() && data + size <= container->constData() + container->size());
+        QByteArray::DataPointer dataPointer = container->data_ptr();
+        dataPointer.ptr = const_cast<char *>(data);
+        dataPointer.size = size;
+        return QByteArray(std::move(dataPointer));
+    }
+#else
+    Q_UNUSED(container)
+#endif
+    return QByteArray(data, size);
+}
+
+void QProtobufSerializerPrivate::deserializeMessage(QObject *object, const QProtobufMetaObject &metaObject, QProtobufSelfcheckIterator &it)
+{
+    //Property values are read once and written back once after the message is parsed. This allows to append
+    //elements of repeated fields and maps in place, without copying the whole container for every element.
+    PropertyValues propertyValues;
+    auto writeProperties = [&propertyValues, object, &metaObject]() {
+        for (const auto &propertyValue : propertyValues) {
+            metaObject.staticMetaObject.property(propertyValue.first).write(object, propertyValue.second);
+        }
+    };
+
+    const FieldDispatchTable &table = metaObject.dispatchTable();
+    QProtobufUnknownFields *unknownFields = metaObject.unknownFields(object);
+    try {
+        while (it.size() > 0) {
+            deserializeProperty(object, table, it, propertyValues, unknownFields);
+        }
+    } catch (...) {
+        //Keep fields that were parsed before the failure
+        writeProperties();
+        throw;
+    }
+    writeProperties();
+}
+
+void QProtobufSerializerPrivate::deserializeProperty(QObject *object, const FieldDispatchTable &table, QProtobufSelfcheckIterator &it,
+                                                     PropertyValues &propertyValues, QProtobufUnknownFields *unknownFields)
 {
     //Each iteration we expect iterator is setup to beginning of next chunk
+    const char *fieldBegin = it.data();
     int fieldNumber = QtProtobufPrivate::NotUsedFieldIndex;
     WireTypes wireType = UnknownWireType;
     if (!QProtobufSerializerPrivate::decodeHeader(it, fieldNumber, wireType)) {
@@ -294,59 +951,253 @@ void QProtobufSerializerPrivate::deserializeProperty(QObject *object, const QPro
                               "Seems stream is broken");
     }
 
-    auto propertyNumberIt = metaObject.propertyOrdering.find(fieldNumber);
-    if (propertyNumberIt == std::end(metaObject.propertyOrdering)) {
+    const FieldDispatchEntry *field = table.find(fieldNumber);
+    if (field == nullptr) {
         auto bytesCount = QProtobufSerializerPrivate::skipSerializedFieldBytes(it, wireType);
+        if (unknownFields != nullptr) {
+            //Field is kept as is, with header, sharing data with the input buffer
+            unknownFields->append(sharedData(it.container(), fieldBegin, static_cast<int>(it.data() - fieldBegin)));
+            qProtoDebug() << "Message received contains unknown field. WireType:" << wireType
+                          << ", field number: " << fieldNumber << "Preserved:" << (it.data() - fieldBegin) << "bytes";
+            return;
+        }
         qProtoWarning() << "Message received contains unexpected/optional field. WireType:" << wireType
                         << ", field number: " << fieldNumber << "Skipped:" << (bytesCount + 1) << "bytes";
         return;
     }
 
-    int propertyIndex = propertyNumberIt->second;
-    QMetaProperty metaProperty = metaObject.staticMetaObject.property(propertyIndex);
-
-    qProtoDebug() << __func__ << " wireType: " << wireType << " metaProperty: " << metaProperty.typeName()
+    qProtoDebug() << __func__ << " wireType: " << wireType << " expected wireType: " << field->wireType
+                  << " metaProperty: " << field->metaProperty->typeName()
                   << "currentByte:" << QString::number((*it), 16);
 
-    QVariant newPropertyValue;
-    newPropertyValue = metaProperty.read(object);
-    int userType = metaProperty.userType();
+    auto propertyValueIt = propertyValues.find(field->propertyIndex);
+    if (propertyValueIt == propertyValues.end()) {
+        propertyValueIt = propertyValues.emplace(field->propertyIndex, field->metaProperty->read(object)).first;
+    }
+    QVariant &newPropertyValue = propertyValueIt->second;
 
-    //TODO: replace with some common function
-    auto basicIt = handlers.find(userType);
-    if (basicIt != handlers.end()) {
-        basicIt->second.deserializer(it, newPropertyValue);
+    if (field->basicHandlers != nullptr) {
+        field->basicHandlers->deserializer(it, newPropertyValue);
+    } else if (field->handler != nullptr) {
+        field->handler->deserializer(q_ptr, it, newPropertyValue);
     } else {
-        auto handler = QtProtobufPrivate::findHandler(userType);
+        //Handler was not registered when dispatch table was built
+        const auto &handler = QtProtobufPrivate::findHandler(field->userType);
         handler.deserializer(q_ptr, it, newPropertyValue);
     }
+}
+
+QProtobufFieldDispatchTable::QProtobufFieldDispatchTable(const std::vector<QProtobufMetaProperty> &metaProperties)
+{
+    //Meta properties are already sorted by field number
+    m_fields.reserve(metaProperties.size());
+    for (const auto &metaProperty : metaProperties) {
+        FieldDispatchEntry entry;
+        entry.fieldNumber = metaProperty.protoFieldIndex();
+        entry.propertyIndex = metaProperty.propertyIndex();
+        entry.userType = metaProperty.userType();
+        entry.metaProperty = &metaProperty;
+
+        auto basicIt = QProtobufSerializerPrivate::handlers.find(entry.userType);
+        if (basicIt != QProtobufSerializerPrivate::handlers.end()) {
+            entry.basicHandlers = &(basicIt->second);
+            entry.wireType = basicIt->second.type;
+            entry.packedWireType = packedElementWireType(entry.userType);
+            entry.packedDecoder = packedDecoder(entry.userType);
+        } else {
+            const auto &handler = QtProtobufPrivate::findHandler(entry.userType);
+            if (handler.serializer || handler.deserializer) {
+                entry.handler = &handler;
+            }
+            entry.wireType = LengthDelimited;
+        }
+        m_fields.push_back(entry);
+    }
+
+    const int maxFieldNumber = m_fields.empty() ? 0 : m_fields.back().fieldNumber;
+    const int denseLimit = std::min(maxFieldNumber,
+                                    std::max(MinimumDenseFieldNumber,
+                                             static_cast<int>(m_fields.size()) * DenseFieldRatio));
+    m_dense.assign(denseLimit + 1, -1);
+    for (std::size_t i = 0; i < m_fields.size() && m_fields[i].fieldNumber <= denseLimit; ++i) {
+        m_dense[m_fields[i].fieldNumber] = static_cast<int>(i);
+    }
+}
 
-    metaProperty.write(object, newPropertyValue);
+const QProtobufFieldDispatchTable::FieldDispatchEntry *QProtobufFieldDispatchTable::findSparse(int fieldNumber) const
+{
+    auto it = std::lower_bound(m_fields.begin(), m_fields.end(), fieldNumber, [](const FieldDispatchEntry &entry, int number) {
+        return entry.fieldNumber < number;
+    });
+    if (it == m_fields.end() || it->fieldNumber != fieldNumber) {
+        return nullptr;
+    }
+    return &(*it);
+}
+
+QProtobufDecodeResult QProtobufSerializerPrivate::validateMessage(const char *data, const char *it, const char *end,
+                                                                  const QProtobufMetaObject *metaObject,
+                                                                  const QProtobufMetaObject *mapValueMetaObject, int depth)
+{
+    if (depth > QProtobufDecodeResult::MaxNestingDepth) {
+        return {QProtobufDecodeResult::NestingTooDeep, it - data};
+    }
+
+    const FieldDispatchTable *table = metaObject != nullptr ? &metaObject->dispatchTable() : nullptr;
+    while (it != end) {
+        const char *fieldBegin = it;
+        auto failure = [data, fieldBegin](QProtobufDecodeResult::Status status) {
+            return QProtobufDecodeResult{status, fieldBegin - data};
+        };
+
+        uint64_t header = 0;
+        QProtobufDecodeResult::Status status = scanVarint(it, end, header);
+        if (status != QProtobufDecodeResult::NoError) {
+            return failure(status);
+        }
+
+        const uint64_t fieldNumber = header >> 3;
+        const WireTypes wireType = static_cast<WireTypes>(header & 0b00000111);
+        if (fieldNumber == 0 || fieldNumber > MaxFieldNumber) {
+            return failure(QProtobufDecodeResult::InvalidFieldNumber);
+        }
+        if (wireType != Varint && wireType != Fixed64 && wireType != Fixed32 && wireType != LengthDelimited) {
+            return failure(QProtobufDecodeResult::InvalidWireType);
+        }
+
+        WireTypes expectedWireType = UnknownWireType;
+        WireTypes packedWireType = UnknownWireType;
+        const QProtobufMetaObject *nestedMetaObject = nullptr;
+        const QProtobufMetaObject *nestedMapValueMetaObject = nullptr;
+        bool isMapEntry = false;
+        const FieldDispatchEntry *field = table != nullptr ? table->find(static_cast<int>(fieldNumber)) : nullptr;
+        if (field != nullptr && field->basicHandlers != nullptr) {
+            expectedWireType = field->wireType;
+            packedWireType = field->packedWireType;
+        } else if (field != nullptr) {
+            const auto &handler = field->handler != nullptr ? *(field->handler)
+                                                            : QtProtobufPrivate::findHandler(field->userType);
+            if (handler.deserializer) {
+                switch (handler.type) {
+                case QtProtobufPrivate::ObjectHandler:
+                    //Registered types without message metaobject are enumerations
+                    expectedWireType = handler.metaObject != nullptr ? LengthDelimited : Varint;
+                    nestedMetaObject = handler.metaObject;
+                    break;
+                case QtProtobufPrivate::ListHandler:
+                    expectedWireType = LengthDelimited;
+                    nestedMetaObject = handler.metaObject;
+                    packedWireType = handler.metaObject != nullptr ? UnknownWireType : Varint;
+                    break;
+                case QtProtobufPrivate::MapHandler:
+                    expectedWireType = LengthDelimited;
+                    nestedMapValueMetaObject = handler.metaObject;
+                    isMapEntry = true;
+                    break;
+                }
+            }
+        } else if (table == nullptr && mapValueMetaObject != nullptr && fieldNumber == 2) {
+            expectedWireType = LengthDelimited;
+            nestedMetaObject = mapValueMetaObject;
+        }
+
+        if (expectedWireType != UnknownWireType && wireType != expectedWireType) {
+            return failure(QProtobufDecodeResult::WireTypeMismatch);
+        }
+
+        switch (wireType) {
+        case Varint: {
+            uint64_t value = 0;
+            status = scanVarint(it, end, value);
+            if (status != QProtobufDecodeResult::NoError) {
+                return failure(status);
+            }
+            break;
+        }
+        case Fixed32:
+            if (end - it < static_cast<qsizetype>(sizeof(decltype(fixed32::_t)))) {
+                return failure(QProtobufDecodeResult::TruncatedData);
+            }
+            it += sizeof(decltype(fixed32::_t));
+            break;
+        case Fixed64:
+            if (end - it < static_cast<qsizetype>(sizeof(decltype(fixed64::_t)))) {
+                return failure(QProtobufDecodeResult::TruncatedData);
+            }
+            it += sizeof(decltype(fixed64::_t));
+            break;
+        case LengthDelimited: {
+            uint64_t length = 0;
+            status = scanVarint(it, end, length);
+            if (status != QProtobufDecodeResult::NoError) {
+                return failure(status);
+            }
+            if (length > static_cast<uint64_t>(end - it)) {
+                return failure(QProtobufDecodeResult::TruncatedData);
+            }
+            const char *payload = it;
+            it += length;
+            if (packedWireType != UnknownWireType && !isValidPacked(payload, it, packedWireType)) {
+                return failure(QProtobufDecodeResult::InvalidPackedField);
+            }
+            if (nestedMetaObject != nullptr || isMapEntry) {
+                QProtobufDecodeResult nestedResult = validateMessage(data, payload, it, nestedMetaObject,
+                                                                     nestedMapValueMetaObject, depth + 1);
+                if (!nestedResult.ok()) {
+                    return nestedResult;
+                }
+            }
+            break;
+        }
+        default:
+            break;
+        }
+    }
+    return {};
+}
+
+bool QProtobufSerializerPrivate::isValidPacked(const char *it, const char *end, WireTypes elementType)
+{
+    switch (elementType) {
+    case Fixed32:
+        return (end - it) % sizeof(decltype(fixed32::_t)) == 0;
+    case Fixed64:
+        return (end - it) % sizeof(decltype(fixed64::_t)) == 0;
+    case Varint:
+        while (it != end) {
+            uint64_t value = 0;
+            if (scanVarint(it, end, value) != QProtobufDecodeResult::NoError) {
+                return false;
+            }
+        }
+        return true;
+    default:
+        return true;
+    }
 }
 
 void QProtobufSerializerPrivate::deserializeMapPair(QVariant &key, QVariant &value, QProtobufSelfcheckIterator &it)
 {
     int mapIndex = 0;
     WireTypes type = WireTypes::UnknownWireType;
-    unsigned int count = QProtobufSerializerPrivate::deserializeVarintCommon<uint32>(it);
-    qProtoDebug() << __func__ << "count:" << count;
-    QProtobufSelfcheckIterator last = it + count;
-    while (it != last) {
-        QProtobufSerializerPrivate::decodeHeader(it, mapIndex, type);
+    QProtobufSelfcheckIterator pairIt = QProtobufSerializerPrivate::deserializeLengthDelimitedView(it);
+    qProtoDebug() << __func__ << "count:" << pairIt.size();
+    while (pairIt.size() > 0) {
+        QProtobufSerializerPrivate::decodeHeader(pairIt, mapIndex, type);
         if (mapIndex == 1) {
             //Only simple types are supported as keys
             int userType = key.userType();
             auto &handler = handlers.at(userType);//throws if not found
-            handler.deserializer(it, key);
+            handler.deserializer(pairIt, key);
         } else {
             //TODO: replace with some common function
             int userType = value.userType();
             auto basicIt = handlers.find(userType);
             if (basicIt != handlers.end()) {
-                basicIt->second.deserializer(it, value);
+                basicIt->second.deserializer(pairIt, value);
             } else {
-                auto handler = QtProtobufPrivate::findHandler(userType);
-                handler.deserializer(q_ptr, it, value);//throws if not implemented
+                const auto &handler = QtProtobufPrivate::findHandler(userType);
+                handler.deserializer(q_ptr, pairIt, value);//throws if not implemented
             }
         }
     }
@@ -34,33 +34,91 @@ class QProtobufSerializerPrivate;
 /*!
  * \ingroup QtProtobuf
  * \brief The QProtobufSerializer class
+ *
+ * \details Serialization is deterministic: fields are written in ascending field number order and map
+ *          entries are written in ascending key order. Equal messages are serialized to equal bytes, so
+ *          serialized messages and their hashes may be used as cache keys.
  */
 class Q_PROTOBUF_EXPORT QProtobufSerializer : public QAbstractProtobufSerializer
 {
 public:
-    QProtobufSerializer();
+    /*!
+     * \brief The DefaultValuesMode enum defines if fields that hold proto3 default values are written
+     */
+    enum DefaultValuesMode {
+        ElideDefaultValues, //!< Singular scalar fields that hold default values are not written, as proto3 requires:
+                            //!< zero fixed-width and floating point values, and empty strings and bytes. Negative
+                            //!< zero is written.
+        WriteDefaultValues  //!< Only zero varint values are skipped, as in previous versions
+    };
+
+    /*!
+     * \brief Constructs serializer that handles default values according to \a mode
+     *
+     * \details Mode can't be changed after construction, so serializer may be shared between threads. Keys and
+     *          values of map entries are written regardless of \a mode, unless they are zero varints.
+     */
+    explicit QProtobufSerializer(DefaultValuesMode mode = ElideDefaultValues);
     ~QProtobufSerializer();
 
+    bool supportsDirectSerialization() const override { return true; }
+    bool supportsDirectWriting() const override;
+
+    /*!
+     * \brief Returns true if fields that hold proto3 default values are not written
+     */
+    bool defaultValuesElided() const;
+
+    /*!
+     * \brief Returns 64-bit content hash of registered qtproto message \a object
+     *
+     * \details Hash is calculated over deterministic serialized form of \a object, so equal messages
+     *          have equal hashes.
+     */
+    template<typename T>
+    quint64 hash(const QObject *object, quint64 seed = 0) {
+        return contentHash(serialize<T>(object), seed);
+    }
+
+    /*!
+     * \brief Returns 64-bit hash of \a data
+     *
+     * \details Uses XXH64 algorithm. Result doesn't depend on platform and may be stored or sent.
+     */
+    static quint64 contentHash(const QByteArray &data, quint64 seed = 0);
+
 protected:
     QByteArray serializeMessage(const QObject *object, const QProtobufMetaObject &metaObject) const override;
+    void serializeMessage(const QObject *object, const QProtobufMetaObject &metaObject, QByteArray &out) const override;
+    bool serializeMessage(const QObject *object, const QProtobufMetaObject &metaObject, QIODevice *device) const override;
     void deserializeMessage(QObject *object, const QProtobufMetaObject &metaObject, const QByteArray &data) const override;
+    QProtobufDecodeResult validateMessage(const QProtobufMetaObject &metaObject, const QByteArray &data) const override;
 
     QByteArray serializeObject(const QObject *object, const QProtobufMetaObject &metaObject, const QProtobufMetaProperty &metaProperty) const override;
+    void serializeObject(const QObject *object, const QProtobufMetaObject &metaObject, const QProtobufMetaProperty &metaProperty, QByteArray &out) const override;
     void deserializeObject(QObject *object, const QProtobufMetaObject &metaObject, QProtobufSelfcheckIterator &it) const override;
 
     QByteArray serializeListObject(const QObject *object, const QProtobufMetaObject &metaObject, const QProtobufMetaProperty &metaProperty) const override;
+    void serializeListObject(const QObject *object, const QProtobufMetaObject &metaObject, const QProtobufMetaProperty &metaProperty, QByteArray &out) const override;
     bool deserializeListObject(QObject *object, const QProtobufMetaObject &metaObject, QProtobufSelfcheckIterator &it) const override;
 
     QByteArray serializeMapPair(const QVariant &key, const QVariant &value, const QProtobufMetaProperty &metaProperty) const override;
+    void serializeMapPair(const QVariant &key, const QVariant &value, const QProtobufMetaProperty &metaProperty, QByteArray &out) const override;
     bool deserializeMapPair(QVariant &key, QVariant &value, QProtobufSelfcheckIterator &it) const override;
 
     QByteArray serializeEnum(int64 value, const QMetaEnum &metaEnum, const QtProtobuf::QProtobufMetaProperty &metaProperty) const override;
     QByteArray serializeEnumList(const QList<int64> &value, const QMetaEnum &metaEnum, const QtProtobuf::QProtobufMetaProperty &metaProperty) const override;
+    void serializeEnum(int64 value, const QMetaEnum &metaEnum, const QtProtobuf::QProtobufMetaProperty &metaProperty, QByteArray &out) const override;
+    void serializeEnumList(const QList<int64> &value, const QMetaEnum &metaEnum, const QtProtobuf::QProtobufMetaProperty &metaProperty, QByteArray &out) const override;
 
     void deserializeEnum(int64 &value, const QMetaEnum &metaEnum, QProtobufSelfcheckIterator &it) const override;
     void deserializeEnumList(QList<int64> &value, const QMetaEnum &metaEnum, QProtobufSelfcheckIterator &it) const override;
 
     std::unique_ptr<QProtobufSerializerPrivate> dPtr;
+
+private:
+    friend class QProtobufStreamParser;
+    friend class QProtobufDelimitedWriter;
 };
 
 }
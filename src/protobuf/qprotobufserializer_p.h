@@ -25,20 +25,55 @@
 
 #include <QString>
 #include <QByteArray>
+#include <QMetaProperty>
+
+#include <limits>
+#include <map>
+#include <stdexcept>
+#include <vector>
+#include <cstring>
 
 #include "qprotobufselfcheckiterator.h"
+#include "qprotobufpackedcodec_p.h"
 #include "qtprotobuftypes.h"
 #include "qtprotobuflogging.h"
 #include "qabstractprotobufserializer.h"
+#include "qprotobufunknownfields.h"
 
 namespace QtProtobuf {
 
+//! \private
+template <typename V>
+struct IsFixedWidthType : std::integral_constant<bool, std::is_floating_point<V>::value
+                                                       || std::is_same<V, fixed32>::value
+                                                       || std::is_same<V, fixed64>::value
+                                                       || std::is_same<V, sfixed32>::value
+                                                       || std::is_same<V, sfixed64>::value> {};
+
+//! \private
+template <typename V>
+struct IsVarintType : std::integral_constant<bool, std::is_integral<V>::value
+                                                   || std::is_same<V, int32>::value
+                                                   || std::is_same<V, int64>::value> {};
+
+//! \private
+template <typename V>
+struct IsLengthDelimitedType : std::integral_constant<bool, std::is_same<V, QString>::value
+                                                            || std::is_same<V, QByteArray>::value> {};
+
 /*!
  * \ingroup QtProtobuf
  * \private
  * \brief The QProtobufSerializerPrivate class
+ *
+ * \details Serialization is performed in two passes. The first pass calculates the exact size of every
+ *          message and nested message, the second one writes the data into a single buffer that is reserved
+ *          up front. Sizes of nested messages are stored in pre-order during the first pass and consumed in
+ *          the same order during the second one, so the length prefix of a nested message is always written
+ *          before its payload and no data is moved or copied afterwards.
  */
 class QProtobufSerializer;
+class QProtobufFieldDispatchTable;
 //! \private
 class QProtobufSerializerPrivate final
 {
@@ -46,227 +81,375 @@ class QProtobufSerializerPrivate final
 public:
 
     /*!
-     * \brief Serializer is interface function for serialize method
+     * \brief SizeCalculator is interface function that calculates size of value serialized without header
+     *
+     * \details Sets field index to QtProtobufPrivate::NotUsedFieldIndex if the header must not be written
+     */
+    using SizeCalculator = qsizetype(*)(const QVariant &, int &);
+    /*!
+     * \brief Writer is interface function that appends serialized value without header to the buffer
      */
-    using Serializer = QByteArray(*)(const QVariant &, int &);
+    using Writer = void(*)(const QVariant &, int, QByteArray &);
     /*!
      * \brief Deserializer is interface function for deserialize method
      */
     using Deserializer = void(*)(QProtobufSelfcheckIterator &, QVariant &);
+    /*!
+     * \brief DefaultChecker is interface function that returns true if value is proto3 default value of its type
+     */
+    using DefaultChecker = bool(*)(const QVariant &);
+    /*!
+     * \brief PackedDecoder is interface function that appends elements of packed list payload to the list value
+     */
+    using PackedDecoder = void(*)(const char *, const char *, QVariant &);
 
     /*!
      * \private
      * \brief SerializationHandlers contains set of objects that required for class serializaion/deserialization
      */
     struct SerializationHandlers {
-        Serializer serializer; /*!< serializer assigned to class */
+        SizeCalculator sizeCalculator; /*!< serialized size calculator assigned to class */
+        Writer writer; /*!< writer assigned to class */
         Deserializer deserializer;/*!< deserializer assigned to class */
         WireTypes type;/*!< Serialization WireType */
+        DefaultChecker isDefault; /*!< default value checker assigned to class */
     };
 
     using SerializerRegistry = std::unordered_map<int/*metatypeid*/, SerializationHandlers>;
 
-    QProtobufSerializerPrivate(QProtobufSerializer *q);
+    /*!
+     * \private
+     * \brief Pre-resolved serialization data of message field
+     */
+    struct FieldDispatchEntry {
+        int fieldNumber = QtProtobufPrivate::NotUsedFieldIndex; /*!< protobuf field number */
+        int propertyIndex = -1; /*!< index of property in QMetaObject */
+        int userType = QMetaType::UnknownType; /*!< metatype id of property */
+        const QProtobufMetaProperty *metaProperty = nullptr; /*!< property assigned to field, owned by QProtobufMetaObject */
+        WireTypes wireType = UnknownWireType; /*!< expected WireType of field */
+        const SerializationHandlers *basicHandlers = nullptr; /*!< handlers of basic type, if any */
+        const QtProtobufPrivate::SerializationHandler *handler = nullptr; /*!< handler of registered type, if it was
+                                                                              registered when table was built */
+        WireTypes packedWireType = UnknownWireType; /*!< WireType of elements of packed basic type list, if any */
+        PackedDecoder packedDecoder = nullptr; /*!< decoder of packed basic type list, if any */
+    };
+
+    //! Field dispatch table of message type, that is stored in QProtobufMetaObject
+    using FieldDispatchTable = QProtobufFieldDispatchTable;
+
+    /*!
+     * \private
+     * \brief Checks that data from \a it up to \a end is well-formed message, without throwing on malformed data
+     *
+     * \details Fields known to \a metaObject are checked against types of their properties and nested messages are
+     *          checked recursively. If \a metaObject is null only structure of fields is checked, except field 2 of
+     *          map entry, that is checked as message of \a mapValueMetaObject type, if it's set. Offsets in result are
+     *          relative to \a data.
+     */
+    static QProtobufDecodeResult validateMessage(const char *data, const char *it, const char *end,
+                                                 const QProtobufMetaObject *metaObject,
+                                                 const QProtobufMetaObject *mapValueMetaObject, int depth);
+
+    /*!
+     * \private
+     * \brief Returns true if data from \a it up to \a end is sequence of complete elements of \a elementType
+     */
+    static bool isValidPacked(const char *it, const char *end, WireTypes elementType);
+
+    QProtobufSerializerPrivate(QProtobufSerializer *q, bool elideDefaultValues);
     ~QProtobufSerializerPrivate() = default;
     //###########################################################################
     //                               Serializers
     //###########################################################################
 
+    /*!
+     * \brief Calculates number of bytes required to store \a value using
+     *        <a href="https://developers.google.com/protocol-buffers/docs/encoding">Varint encoding</a>
+     */
     template <typename V,
               typename std::enable_if_t<std::is_integral<V>::value
                                         && std::is_unsigned<V>::value, int> = 0>
-    static QByteArray serializeVarintCommon(const V &value) {
-        qProtoDebug() << __func__ << "value" << value;
-        V varint = value;
-        QByteArray result;
-
-        while (varint != 0) {
-            //Put 7 bits to result buffer and mark as "not last" (0b10000000)
-            result.append((varint & 0b01111111) | 0b10000000);
-            //Divide values to chunks of 7 bits and move to next chunk
-            varint >>= 7;
-        }
-
-        if (result.isEmpty()) {
-            result.append('\0');
+    static qsizetype varintSize(V value) {
+        qsizetype size = 1;
+        while (value >= 0b10000000) {
+            value >>= 7;
+            ++size;
         }
+        return size;
+    }
 
-        result.data()[result.size() - 1] &= ~0b10000000;
-        return result;
+    /*!
+     * \brief Appends \a value encoded using
+     *        <a href="https://developers.google.com/protocol-buffers/docs/encoding">Varint encoding</a>
+     *        to \a out. Zero value is encoded as single zero byte.
+     */
+    template <typename V,
+              typename std::enable_if_t<std::is_integral<V>::value
+                                        && std::is_unsigned<V>::value, int> = 0>
+    static void writeVarint(V value, QByteArray &out) {
+        char buffer[QProtobufPackedCodec::MaxVarintSize];
+        out.append(buffer, QProtobufPackedCodec::encodeVarint(value, buffer) - buffer);
     }
 
     //---------------Integral and floating point types serializers---------------
     /*!
-     * \brief Serialization of fixed-length primitive types
+     * \brief Converts unsigned integral value to its varint representation as is
+     */
+    template <typename V,
+              typename std::enable_if_t<std::is_integral<V>::value
+                                        && std::is_unsigned<V>::value, int> = 0>
+    static V toVarint(const V &value) {
+        return value;
+    }
+
+    /*!
+     * \brief Converts signed integral value to its varint representation
      *
-     * Natural layout of bits is used: value is encoded in a byte array same way as it is located in memory
+     * Use <a href="https://developers.google.com/protocol-buffers/docs/encoding">ZigZag encoding</a>
+     */
+    template <typename V,
+              typename std::enable_if_t<std::is_integral<V>::value
+                                        && std::is_signed<V>::value, int> = 0>
+    static typename std::make_unsigned<V>::type toVarint(const V &value) {
+        using UV = typename std::make_unsigned<V>::type;
+        return (static_cast<UV>(value) << 1) ^ static_cast<UV>(value >> (sizeof(UV) * 8 - 1));
+    }
+
+    /*!
+     * \brief Converts int32 and int64 values to their varint representation without ZigZag encoding
+     */
+    template <typename V,
+              typename std::enable_if_t<std::is_same<V, int32>::value
+                                        || std::is_same<V, int64>::value, int> = 0>
+    static typename std::make_unsigned<V>::type toVarint(const V &value) {
+        using UV = typename std::make_unsigned<V>::type;
+        return static_cast<UV>(value);
+    }
+
+    /*!
+     * \brief Size of the fixed-length primitive types element. Natural layout of bits is used.
+     */
+    template <typename V,
+              typename std::enable_if_t<IsFixedWidthType<V>::value, int> = 0>
+    static constexpr qsizetype elementSize(const V &) {
+        return sizeof(V);
+    }
+
+    /*!
+     * \brief Size of the varint encoded element. Zero value takes single byte.
+     */
+    template <typename V,
+              typename std::enable_if_t<IsVarintType<V>::value, int> = 0>
+    static qsizetype elementSize(const V &value) {
+        return varintSize(toVarint(value));
+    }
+
+    /*!
+     * \brief Appends fixed-length primitive type to \a out
      *
-     * \param[in] value Value to serialize
-     * \param[out] outFieldIndex Index of the value in parent structure (ignored)
-     * \return Byte array with value encoded
+     * Natural layout of bits is used: value is encoded in a byte array same way as it is located in memory
      */
     template <typename V,
-              typename std::enable_if_t<std::is_floating_point<V>::value, int> = 0>
-    static QByteArray serializeBasic(const V &value, int &/*outFieldIndex*/) {
-        qProtoDebug() << __func__ << "value" << value;
+              typename std::enable_if_t<IsFixedWidthType<V>::value, int> = 0>
+    static void writeElement(const V &value, QByteArray &out) {
+        const qsizetype offset = out.size();
+        out.resize(offset + sizeof(V));
+        QProtobufPackedCodec::writeFixed(&value, out.data() + offset, 1);
+    }
 
-        //Reserve required number of bytes
-        QByteArray result(sizeof(V), '\0');
-        *reinterpret_cast<V *>(result.data()) = value;
-        return result;
+    /*!
+     * \brief Appends varint encoded value to \a out
+     */
+    template <typename V,
+              typename std::enable_if_t<IsVarintType<V>::value, int> = 0>
+    static void writeElement(const V &value, QByteArray &out) {
+        writeVarint(toVarint(value), out);
     }
 
     /*!
-     * \brief Serialization of fixed length integral types
+     * \brief Size of the fixed-length primitive types
      *
-     * \details Natural layout of bits is employed
+     * \details Zero values are not skipped here. Callers decide if the field is written, using isDefaultValue.
      *
      * \param[in] value Value to serialize
      * \param[out] outFieldIndex Index of the value in parent structure (ignored)
-     * \return Byte array with value encoded
+     * \return Number of bytes required for value
      */
     template <typename V,
-              typename std::enable_if_t<std::is_same<V, fixed32>::value
-                                        || std::is_same<V, fixed64>::value
-                                        || std::is_same<V, sfixed32>::value
-                                        || std::is_same<V, sfixed64>::value, int> = 0>
-    static QByteArray serializeBasic(const V &value, int &/*outFieldIndex*/) {
-        qProtoDebug() << __func__ << "value" << value;
-
-        //Reserve required number of bytes
-        QByteArray result(sizeof(V), '\0');
-        *reinterpret_cast<V *>(result.data()) = value;
-        return result;
+              typename std::enable_if_t<IsFixedWidthType<V>::value, int> = 0>
+    static qsizetype sizeBasic(const V &value, int &/*outFieldIndex*/) {
+        return elementSize(value);
     }
 
     /*!
-     *\brief Serialization of signed integral types
-     *
-     * Use <a href="https://developers.google.com/protocol-buffers/docs/encoding">ZigZag encoding</a> first,
-     * then apply serialization as for unsigned integral types
-     * \see serializeBasic\<typename V, typename std::enable_if_t\<std::is_integral\<V\>::value && std::is_unsigned\<V\>::value, int\> = 0\>(V, int)
+     * \brief Size of the varint encoded types.
      *
      * \param[in] value Value to serialize
-     * \param[out] outFieldIndex Index of the value in parent structure
-     * \return Byte array with value encoded
+     * \param[out] outFieldIndex Index of the value in parent structure. Set to
+     *             QtProtobufPrivate::NotUsedFieldIndex in case if value is zero and field should not be sent
+     * \return Number of bytes required for value
      */
     template <typename V,
-              typename std::enable_if_t<std::is_integral<V>::value
-                                        && std::is_signed<V>::value, int> = 0>
-    static QByteArray serializeBasic(const V &value, int &outFieldIndex) {
+              typename std::enable_if_t<IsVarintType<V>::value, int> = 0>
+    static qsizetype sizeBasic(const V &value, int &outFieldIndex) {
+        const auto varint = toVarint(value);
+        if (varint == 0) {
+            outFieldIndex = QtProtobufPrivate::NotUsedFieldIndex;
+            return 0;
+        }
+        return varintSize(varint);
+    }
+
+    template <typename V,
+              typename std::enable_if_t<IsFixedWidthType<V>::value
+                                        || IsVarintType<V>::value, int> = 0>
+    static void writeBasic(const V &value, int /*fieldIndex*/, QByteArray &out) {
         qProtoDebug() << __func__ << "value" << value;
-        using UV = typename std::make_unsigned<V>::type;
-        UV uValue = 0;
+        writeElement(value, out);
+    }
 
-        //Use ZigZag convertion first and apply unsigned variant next
-        V zigZagValue = (value << 1) ^ (value >> (sizeof(UV) * 8 - 1));
-        uValue = static_cast<UV>(zigZagValue);
-        return serializeBasic(uValue, outFieldIndex);
+    //------------------QString and QByteArray types serializers-----------------
+    template <typename V,
+              typename std::enable_if_t<IsLengthDelimitedType<V>::value, int> = 0>
+    static qsizetype sizeBasic(const V &value, int &/*outFieldIndex*/) {
+        return lengthDelimitedSize(value);
     }
 
     template <typename V,
-              typename std::enable_if_t<std::is_same<V, int32>::value
-                                        || std::is_same<V, int64>::value, int> = 0>
-    static QByteArray serializeBasic(const V &value, int &outFieldIndex) {
-        qProtoDebug() << __func__ << "value" << value;
-        using UV = typename std::make_unsigned<V>::type;
-        return serializeBasic(static_cast<UV>(value), outFieldIndex);
+              typename std::enable_if_t<IsLengthDelimitedType<V>::value, int> = 0>
+    static void writeBasic(const V &value, int /*fieldIndex*/, QByteArray &out) {
+        writeLengthDelimited(value, out);
     }
 
+    //--------------------------Default values detection-------------------------
     /*!
-    *\brief Serialization of unsigned integral types
-    *
-    * Use <a href="https://developers.google.com/protocol-buffers/docs/encoding">Varint encoding</a>:
-    * "Varints are a method of serializing integers using one or more bytes. Smaller numbers
-    * [regardless its type] take a smaller number of bytes."
-    *
-    * \param[in] value Value to serialize
-    * \param[out] outFieldIndex Index of the value in parent structure
-    * \return Byte array with value encoded
-    */
+     * \brief Returns true if fixed-width \a value is default value of its type
+     *
+     * \details Values are compared bitwise, so negative zero of floating point types is not default value and
+     *          is written same way as protobuf reference implementation does.
+     */
     template <typename V,
-              typename std::enable_if_t<std::is_integral<V>::value
-                                        && std::is_unsigned<V>::value, int> = 0>
-    static QByteArray serializeBasic(const V &value, int &outFieldIndex) {
-        qProtoDebug() << __func__ << "value" << value;
-        V varint = value;
-        QByteArray result;
-
-        while (varint != 0) {
-            //Put 7 bits to result buffer and mark as "not last" (0b10000000)
-            result.append((varint & 0b01111111) | 0b10000000);
-            //Divide values to chunks of 7 bits and move to next chunk
-            varint >>= 7;
-        }
-
-        // Invalidate field index in case if serialized result is empty
-        // NOTE: the field will not be sent if its index is equal to NotUsedFieldIndex
-        if (result.size() == 0) {
-            outFieldIndex = QtProtobufPrivate::NotUsedFieldIndex;
-        } else {
-            //Mark last chunk as last by clearing last bit
-            result.data()[result.size() - 1] &= ~0b10000000;
-        }
-        return result;
+              typename std::enable_if_t<IsFixedWidthType<V>::value, int> = 0>
+    static bool isDefaultValue(const V &value) {
+        const V defaultValue{};
+        return std::memcmp(&value, &defaultValue, sizeof(V)) == 0;
     }
 
-    //------------------QString and QByteArray types serializers-----------------
     template <typename V,
-              typename std::enable_if_t<std::is_same<V, QString>::value, int> = 0>
-    static QByteArray serializeBasic(const V &value, int &/*outFieldIndex*/) {
-        return serializeLengthDelimited(value.toUtf8());
+              typename std::enable_if_t<IsLengthDelimitedType<V>::value, int> = 0>
+    static bool isDefaultValue(const V &value) {
+        return value.isEmpty();
     }
 
+    /*!
+     * \brief Zero varints and empty lists are skipped by size calculators, regardless of default values elision
+     */
     template <typename V,
-              typename std::enable_if_t<std::is_same<V, QByteArray>::value, int> = 0>
-    static QByteArray serializeBasic(const V &value, int &/*outFieldIndex*/) {
-        return serializeLengthDelimited(value);
+              typename std::enable_if_t<!(IsFixedWidthType<V>::value || IsLengthDelimitedType<V>::value), int> = 0>
+    static bool isDefaultValue(const V &) {
+        return false;
     }
 
     //--------------------------List types serializers---------------------------
     template<typename V,
-             typename std::enable_if_t<!(std::is_same<V, QString>::value
-                                       || std::is_base_of<QObject, V>::value), int> = 0>
-    static QByteArray serializeListType(const QList<V> &listValue, int &outFieldIndex) {
-        qProtoDebug() << __func__ << "listValue.count" << listValue.count() << "outFiledIndex" << outFieldIndex;
+             typename std::enable_if_t<IsFixedWidthType<V>::value, int> = 0>
+    static qsizetype packedSize(const QList<V> &listValue) {
+        return listValue.size() * sizeof(V);
+    }
 
-        if (listValue.count() <= 0) {
-            outFieldIndex = QtProtobufPrivate::NotUsedFieldIndex;
-            return QByteArray();
+    template<typename V,
+             typename std::enable_if_t<IsVarintType<V>::value, int> = 0>
+    static qsizetype packedSize(const QList<V> &listValue) {
+        qsizetype size = 0;
+        for (const auto &value : listValue) {
+            size += elementSize(value);
         }
+        return size;
+    }
 
-        int empty = QtProtobufPrivate::NotUsedFieldIndex;
-        QByteArray serializedList;
-        for (auto &value : listValue) {
-            QByteArray element = serializeBasic<V>(value, empty);
-            if (element.isEmpty()) {
-                element.append('\0');
-            }
-            serializedList.append(element);
+    template<typename V,
+             typename std::enable_if_t<!(IsLengthDelimitedType<V>::value
+                                       || std::is_base_of<QObject, V>::value), int> = 0>
+    static qsizetype sizeListType(const QList<V> &listValue, int &outFieldIndex) {
+        if (listValue.isEmpty()) {
+            outFieldIndex = QtProtobufPrivate::NotUsedFieldIndex;
+            return 0;
         }
+
+        const qsizetype size = packedSize(listValue);
+        return varintSize(static_cast<uint32_t>(size)) + size;
+    }
+
+    /*!
+     * \brief Bulk encoding of packed fixed-width list
+     *
+     * \details Wire format of packed fixed-width list matches the little-endian in-memory layout of QList,
+     *          so whole list is copied at once.
+     */
+    template<typename V,
+             typename std::enable_if_t<IsFixedWidthType<V>::value, int> = 0>
+    static void writeListType(const QList<V> &listValue, int /*fieldIndex*/, QByteArray &out) {
+        qProtoDebug() << __func__ << "listValue.count" << listValue.count();
+
         //If internal field type is not LengthDelimited, exact amount of fields to be specified
-        serializedList = prependLengthDelimitedSize(serializedList);
-        return serializedList;
+        const qsizetype size = packedSize(listValue);
+        writeVarint(static_cast<uint32_t>(size), out);
+
+        const qsizetype offset = out.size();
+        out.resize(offset + size);
+        QProtobufPackedCodec::writeFixed(listValue.constData(), out.data() + offset, listValue.size());
     }
 
+    /*!
+     * \brief Bulk encoding of packed varint list
+     *
+     * \details Output buffer is resized once and ZigZag/varint encoded elements are written directly to it.
+     */
     template<typename V,
-             typename std::enable_if_t<std::is_same<V, QString>::value, int> = 0>
-    static QByteArray serializeListType(const QStringList &listValue, int &outFieldIndex) {
-        qProtoDebug() << __func__ << "listValue.count" << listValue.count() << "outFiledIndex" << outFieldIndex;
+             typename std::enable_if_t<IsVarintType<V>::value, int> = 0>
+    static void writeListType(const QList<V> &listValue, int /*fieldIndex*/, QByteArray &out) {
+        qProtoDebug() << __func__ << "listValue.count" << listValue.count();
+
+        const qsizetype size = packedSize(listValue);
+        writeVarint(static_cast<uint32_t>(size), out);
+
+        const qsizetype offset = out.size();
+        out.resize(offset + size);
+        char *dst = out.data() + offset;
+        for (const auto &value : listValue) {
+            dst = QProtobufPackedCodec::encodeVarint(toVarint(value), dst);
+        }
+        Q_ASSERT(dst == out.constData() + out.size());
+    }
 
-        if (listValue.count() <= 0) {
+    template<typename V,
+             typename std::enable_if_t<IsLengthDelimitedType<V>::value, int> = 0>
+    static qsizetype sizeListType(const QList<V> &listValue, int &outFieldIndex) {
+        if (listValue.isEmpty()) {
             outFieldIndex = QtProtobufPrivate::NotUsedFieldIndex;
-            return QByteArray();
+            return 0;
         }
 
-        QByteArray serializedList;
-        for (auto &value : listValue) {
-            serializedList.append(QProtobufSerializerPrivate::encodeHeader(outFieldIndex, LengthDelimited));
-            serializedList.append(serializeLengthDelimited(value.toUtf8()));
+        const qsizetype header = headerSize(outFieldIndex, LengthDelimited);
+        qsizetype size = 0;
+        for (const auto &value : listValue) {
+            size += header + lengthDelimitedSize(value);
         }
 
+        //Each element has own header, so common header is not required
         outFieldIndex = QtProtobufPrivate::NotUsedFieldIndex;
-        return serializedList;
+        return size;
+    }
+
+    template<typename V,
+             typename std::enable_if_t<IsLengthDelimitedType<V>::value, int> = 0>
+    static void writeListType(const QList<V> &listValue, int fieldIndex, QByteArray &out) {
+        qProtoDebug() << __func__ << "listValue.count" << listValue.count() << "fieldIndex" << fieldIndex;
+
+        for (const auto &value : listValue) {
+            writeHeader(fieldIndex, LengthDelimited, out);
+            writeLengthDelimited(value, out);
+        }
     }
 
     //###########################################################################
@@ -276,21 +459,13 @@ public:
               typename std::enable_if_t<std::is_integral<V>::value
                                         && std::is_unsigned<V>::value, int> = 0>
     static V deserializeVarintCommon(QProtobufSelfcheckIterator &it) {
-        qProtoDebug() << __func__ << "currentByte:" << QString::number((*it), 16);
+        qProtoDebug() << __func__ << "size left:" << it.size();
 
-        V value = 0;
-        int k = 0;
-        while (true) {
-            uint64_t byte = static_cast<uint64_t>(*it);
-            value += (byte & 0b01111111) << k;
-            k += 7;
-            if (((*it) & 0b10000000) == 0) {
-                break;
-            }
-            ++it;
-        }
-        ++it;
-        return value;
+        uint64_t value = 0;
+        const char *begin = it.data();
+        const char *next = QProtobufPackedCodec::readVarint(begin, begin + it.size(), value);
+        it += static_cast<int>(next - begin);
+        return static_cast<V>(value);
     }
 
     //-------------Integral and floating point types deserializers---------------
@@ -301,15 +476,15 @@ public:
                                         || std::is_same<V, sfixed32>::value
                                         || std::is_same<V, sfixed64>::value, int> = 0>
     static void deserializeBasic(QProtobufSelfcheckIterator &it, QVariant &variantValue) {
-        qProtoDebug() << __func__ << "currentByte:" << QString::number((*it), 16);
+        qProtoDebug() << __func__ << "size left:" << it.size();
 
-#if defined(Q_PROCESSOR_ARM)
+        //Check bounds before reading the value
+        if (it.size() < static_cast<int>(sizeof(V))) {
+            throw std::out_of_range("Container is less than required fields number. Deserialization failed");
+        }
         V v;
-        memcpy(&v, it.data(), sizeof(V));
+        QProtobufPackedCodec::readFixed(it.data(), &v, 1);
         variantValue = QVariant::fromValue(v);
-#else
-        variantValue = QVariant::fromValue(*(V *)((QByteArray::const_iterator&)it));
-#endif
         it += sizeof(V);
     }
 
@@ -354,89 +529,199 @@ public:
     template <typename V,
               typename std::enable_if_t<std::is_same<QString, V>::value, int> = 0>
     static void deserializeBasic(QProtobufSelfcheckIterator &it, QVariant &variantValue) {
-        variantValue = QVariant::fromValue(QString::fromUtf8(deserializeLengthDelimited(it)));
+        variantValue = QVariant::fromValue(deserializeString(it));
     }
 
     //-------------------------List types deserializers--------------------------
+    /*!
+     * \brief Bulk decoding of packed fixed-width list
+     *
+     * \details List is allocated once and packed payload is copied to the list storage at once.
+     */
     template <typename V,
-              typename std::enable_if_t<!std::is_base_of<QObject, V>::value, int> = 0>
+              typename std::enable_if_t<IsFixedWidthType<V>::value, int> = 0>
     static void deserializeList(QProtobufSelfcheckIterator &it, QVariant &previousValue) {
-        qProtoDebug() << __func__ << "currentByte:" << QString::number((*it), 16);
+        qProtoDebug() << __func__ << "size left:" << it.size();
 
+        QProtobufSelfcheckIterator view = deserializeLengthDelimitedView(it);
         QList<V> out;
-        unsigned int count = deserializeVarintCommon<uint32>(it);
-        QProtobufSelfcheckIterator lastVarint = it + count;
-        while (it != lastVarint) {
-            QVariant variantValue;
-            deserializeBasic<V>(it, variantValue);
-            out.append(variantValue.value<V>());
-        }
+        decodePacked<V>(view.data(), view.data() + view.size(), out);
+        previousValue.setValue(out);
+    }
+
+    /*!
+     * \brief Bulk decoding of packed varint list
+     *
+     * \details Number of elements is calculated first, so the list is allocated once and elements are decoded
+     *          directly to the list storage. ZigZag decoding is applied to signed integral types afterwards.
+     */
+    template <typename V,
+              typename std::enable_if_t<IsVarintType<V>::value, int> = 0>
+    static void deserializeList(QProtobufSelfcheckIterator &it, QVariant &previousValue) {
+        qProtoDebug() << __func__ << "size left:" << it.size();
+
+        QProtobufSelfcheckIterator view = deserializeLengthDelimitedView(it);
+        QList<V> out;
+        decodePacked<V>(view.data(), view.data() + view.size(), out);
         previousValue.setValue(out);
     }
 
+    /*!
+     * \brief Appends elements of packed fixed-width list from \a begin up to \a end to \a out
+     */
+    template <typename V,
+              typename std::enable_if_t<IsFixedWidthType<V>::value, int> = 0>
+    static void decodePacked(const char *begin, const char *end, QList<V> &out) {
+        const qsizetype size = end - begin;
+        if (size % sizeof(V) != 0) {
+            throw std::invalid_argument("Packed field size is not multiple of element size. Deserialization failed");
+        }
+
+        const qsizetype offset = out.size();
+        out.resize(offset + size / sizeof(V));
+        QProtobufPackedCodec::readFixed(begin, out.data() + offset, out.size() - offset);
+    }
+
+    /*!
+     * \brief Appends elements of packed varint list from \a begin up to \a end to \a out
+     */
+    template <typename V,
+              typename std::enable_if_t<IsVarintType<V>::value, int> = 0>
+    static void decodePacked(const char *begin, const char *end, QList<V> &out) {
+        using RawType = std::conditional_t<sizeof(V) == sizeof(uint64_t), uint64_t, uint32_t>;
+        static_assert(sizeof(RawType) == sizeof(V), "Varint list element has unexpected size");
+
+        const qsizetype count = QProtobufPackedCodec::countVarints(begin, end);
+        const qsizetype offset = out.size();
+        out.resize(offset + count);
+        V *decoded = out.data() + offset;
+        QProtobufPackedCodec::decodeVarints(begin, end, reinterpret_cast<RawType *>(decoded), count);
+        if constexpr (std::is_integral<V>::value && std::is_signed<V>::value) {
+            using UV = typename std::make_unsigned<V>::type;
+            for (qsizetype i = 0; i < count; ++i) {
+                const UV unsignedValue = static_cast<UV>(decoded[i]);
+                decoded[i] = static_cast<V>((unsignedValue >> 1) ^ (~(unsignedValue & 1) + 1));
+            }
+        }
+    }
+
+    /*!
+     * \brief Appends elements of packed list from \a begin up to \a end to the list stored in \a value
+     */
+    template <typename V>
+    static void appendPacked(const char *begin, const char *end, QVariant &value) {
+        decodePacked<V>(begin, end, QtProtobufPrivate::variantContainer<QList<V>>(value));
+    }
+
+    template <typename V,
+              typename std::enable_if_t<std::is_same<V, QByteArray>::value, int> = 0>
+    static void deserializeList(QProtobufSelfcheckIterator &it, QVariant &previousValue) {
+        QtProtobufPrivate::variantContainer<QByteArrayList>(previousValue).append(deserializeLengthDelimited(it));
+    }
+
+    template <typename V,
+              typename std::enable_if_t<std::is_same<V, QString>::value, int> = 0>
+    static void deserializeList(QProtobufSelfcheckIterator &it, QVariant &previousValue) {
+        QtProtobufPrivate::variantContainer<QStringList>(previousValue).append(deserializeString(it));
+    }
+
     //###########################################################################
     //                             Common functions
     //###########################################################################
-    static QByteArray deserializeLengthDelimited(QProtobufSelfcheckIterator &it) {
+    /*!
+     * \brief Reads length of length-delimited field and returns iterator bounded by the field data
+     *
+     * \details \a it is moved to the end of field data. No data is copied.
+     */
+    static QProtobufSelfcheckIterator deserializeLengthDelimitedView(QProtobufSelfcheckIterator &it) {
         qProtoDebug() << __func__ << "currentByte:" << QString::number((*it), 16);
 
-        unsigned int length = deserializeVarintCommon<uint32>(it);
-        QByteArray result((QByteArray::const_iterator&)it, length); //TODO: it's possible to avoid buffer copying by setuping new "end of QByteArray";
-        it += length;
-        return result;
+        const uint32 length = deserializeVarintCommon<uint32>(it);
+        if (length > static_cast<uint32>(std::numeric_limits<int>::max())) {
+            throw std::out_of_range("Length-delimited field is too large. Deserialization failed");
+        }
+        QProtobufSelfcheckIterator view = it.bounded(static_cast<int>(length));
+        it += static_cast<int>(length);
+        return view;
     }
 
-    static QByteArray serializeLengthDelimited(const QByteArray &data) {
-        qProtoDebug() << __func__ << "data.size" << data.size() << "data" << data.toHex();
-        QByteArray result(data);
-        //Varint serialize field size and apply result as starting point
-        result = prependLengthDelimitedSize(result);
-        return result;
+    static QByteArray deserializeLengthDelimited(QProtobufSelfcheckIterator &it) {
+        QProtobufSelfcheckIterator view = deserializeLengthDelimitedView(it);
+        return sharedData(view.container(), view.data(), view.size());
     }
 
-    static bool decodeHeader(QProtobufSelfcheckIterator &it, int &fieldIndex, WireTypes &wireType);
-    static QByteArray encodeHeader(int fieldIndex, WireTypes wireType);
+    static QString deserializeString(QProtobufSelfcheckIterator &it) {
+        QProtobufSelfcheckIterator view = deserializeLengthDelimitedView(it);
+        return QString::fromUtf8(view.data(), view.size());
+    }
 
-    /*!
-     * \brief Gets length of a byte-array and prepends to it its serialized length value
-     *      using the appropriate serialization algorithm
-     *
-     *
-     * \param[in, out] serializedList Byte-array to be prepended
-     */
-    static QByteArray prependLengthDelimitedSize(const QByteArray &data)
-    {
-        return serializeVarintCommon<uint32_t>(data.size()) + data;
+    static QByteArray sharedData(const QByteArray *container, const char *data, int size);
+
+    static qsizetype lengthDelimitedSize(const QByteArray &data) {
+        return varintSize(static_cast<uint32_t>(data.size())) + data.size();
     }
 
+    static void writeLengthDelimited(const QByteArray &data, QByteArray &out) {
+        qProtoDebug() << __func__ << "data.size" << data.size() << "data" << data.toHex();
+        writeVarint(static_cast<uint32_t>(data.size()), out);
+        out.append(data);
+    }
+
+    static qsizetype utf8Size(const QString &value);
+    static qsizetype lengthDelimitedSize(const QString &value) {
+        const qsizetype size = utf8Size(value);
+        return varintSize(static_cast<uint32_t>(size)) + size;
+    }
+    static void writeLengthDelimited(const QString &value, QByteArray &out);
+
+    static bool decodeHeader(QProtobufSelfcheckIterator &it, int &fieldIndex, WireTypes &wireType);
+    static qsizetype headerSize(int fieldIndex, WireTypes wireType);
+    static void writeHeader(int fieldIndex, WireTypes wireType, QByteArray &out);
+
     template <typename T,
-               QByteArray(*s)(const T &, int &)>
-    static QByteArray serializeWrapper(const QVariant &variantValue, int &fieldIndex) {
+              qsizetype(*s)(const T &, int &)>
+    static qsizetype sizeWrapper(const QVariant &variantValue, int &fieldIndex) {
         if (variantValue.isNull()) {
             fieldIndex = QtProtobufPrivate::NotUsedFieldIndex;
-            return QByteArray();
+            return 0;
         }
         const T& value = *(static_cast<const T *>(variantValue.data()));
         return s(value, fieldIndex);
     }
 
-    template <typename T, QByteArray(*s)(const T &, int &), Deserializer d, WireTypes type,
+    template <typename T>
+    static bool defaultWrapper(const QVariant &variantValue) {
+        return isDefaultValue(*(static_cast<const T *>(variantValue.data())));
+    }
+
+    template <typename T,
+              void(*w)(const T &, int, QByteArray &)>
+    static void writeWrapper(const QVariant &variantValue, int fieldIndex, QByteArray &out) {
+        const T& value = *(static_cast<const T *>(variantValue.data()));
+        w(value, fieldIndex, out);
+    }
+
+    template <typename T, qsizetype(*s)(const T &, int &), void(*w)(const T &, int, QByteArray &), Deserializer d, WireTypes type,
     typename std::enable_if_t<!std::is_base_of<QObject, T>::value, int> = 0>
     static void wrapSerializer() {
         handlers[qMetaTypeId<T>()] = {
-                serializeWrapper<T, s>,
+                sizeWrapper<T, s>,
+                writeWrapper<T, w>,
                 d,
-                type
+                type,
+                defaultWrapper<T>
         };
     }
 
-    template <typename T, typename S, QByteArray(*s)(const S &, int &), Deserializer d, WireTypes type,
+    template <typename T, typename S, qsizetype(*s)(const S &, int &), void(*w)(const S &, int, QByteArray &), Deserializer d, WireTypes type,
     typename std::enable_if_t<!std::is_base_of<QObject, T>::value, int> = 0>
     static void wrapSerializer() {
         handlers[qMetaTypeId<T>()] = {
-                serializeWrapper<S, s>,
+                sizeWrapper<S, s>,
+                writeWrapper<S, w>,
                 d,
-                type
+                type,
+                defaultWrapper<S>
         };
     }
 
@@ -446,19 +731,98 @@ public:
     static void skipVarint(QProtobufSelfcheckIterator &it);
     static void skipLengthDelimited(QProtobufSelfcheckIterator &it);
 
-    QByteArray serializeProperty(const QVariant &propertyValue, const QProtobufMetaProperty &metaProperty);
-    void deserializeProperty(QObject *object, const QProtobufMetaObject &metaObject, QProtobufSelfcheckIterator &it);
+    //! Appends serialized message to \a out. If \a delimited is true, message is prefixed with its varint encoded size
+    void serializeMessage(const QObject *object, const QProtobufMetaObject &metaObject, QByteArray &out,
+                          bool delimited = false);
+    bool serializeMessage(const QObject *object, const QProtobufMetaObject &metaObject, QIODevice *device);
+    void serializeObject(const QObject *object, const QProtobufMetaObject &metaObject, const QProtobufMetaProperty &metaProperty, QByteArray &out);
+    void serializeMapPair(const QVariant &key, const QVariant &value, const QProtobufMetaProperty &metaProperty, QByteArray &out);
+    void serializeProperty(const QVariant &propertyValue, const QProtobufMetaProperty &metaProperty, QByteArray &out);
+
+    qsizetype messageSize(const QObject *object, const QProtobufMetaObject &metaObject);
+    void writeMessage(const QObject *object, const QProtobufMetaObject &metaObject, QByteArray &out);
+    //! Default values are written if \a elideDefaults is false, regardless of defaultValuesElided
+    qsizetype propertySize(const QVariant &propertyValue, const QProtobufMetaProperty &metaProperty, bool elideDefaults = true);
+    void writeProperty(const QVariant &propertyValue, const QProtobufMetaProperty &metaProperty, QByteArray &out,
+                       bool elideDefaults = true);
+    //! Same as above, but use handlers resolved by dispatch table if \a propertyValue holds value of field type
+    qsizetype propertySize(const QVariant &propertyValue, const FieldDispatchEntry &field);
+    void writeProperty(const QVariant &propertyValue, const FieldDispatchEntry &field, QByteArray &out);
+    qsizetype propertySize(const QVariant &propertyValue, const QProtobufMetaProperty &metaProperty,
+                           const SerializationHandlers *basicHandlers, const QtProtobufPrivate::SerializationHandler *handler,
+                           bool elideDefaults);
+    void writeProperty(const QVariant &propertyValue, const QProtobufMetaProperty &metaProperty,
+                       const SerializationHandlers *basicHandlers, const QtProtobufPrivate::SerializationHandler *handler,
+                       QByteArray &out, bool elideDefaults);
+
+    //! Property values accumulated while message is parsed, indexed by property index
+    using PropertyValues = std::map<int, QVariant>;
+
+    void deserializeMessage(QObject *object, const QProtobufMetaObject &metaObject, QProtobufSelfcheckIterator &it);
+    void deserializeProperty(QObject *object, const FieldDispatchTable &table, QProtobufSelfcheckIterator &it,
+                             PropertyValues &propertyValues, QProtobufUnknownFields *unknownFields);
 
     void deserializeMapPair(QVariant &key, QVariant &value, QProtobufSelfcheckIterator &it);
+    //! Fields that hold proto3 default values are not written
+    const bool defaultValuesElided;
+
 private:
+    friend class QProtobufFieldDispatchTable;
     static SerializerRegistry handlers;
     QProtobufSerializer *q_ptr;
 };
 
+/*!
+ * \private
+ * \brief Field dispatch table of message type
+ *
+ * \details Fields are stored sorted by field number. Field numbers up to dense limit are indexed directly,
+ *          rest of fields are looked up using binary search. Table is built once per message type and is owned
+ *          by QProtobufMetaObject of the type.
+ */
+class QProtobufFieldDispatchTable final
+{
+public:
+    using FieldDispatchEntry = QProtobufSerializerPrivate::FieldDispatchEntry;
+
+    explicit QProtobufFieldDispatchTable(const std::vector<QProtobufMetaProperty> &metaProperties);
+    const FieldDispatchEntry *find(int fieldNumber) const {
+        if (fieldNumber >= 0 && fieldNumber < static_cast<int>(m_dense.size())) {
+            const int index = m_dense[fieldNumber];
+            return index >= 0 ? &m_fields[index] : nullptr;
+        }
+        return findSparse(fieldNumber);
+    }
+
+    //! Returns fields of message in ascending field number order
+    const std::vector<FieldDispatchEntry> &fields() const {
+        return m_fields;
+    }
+
+private:
+    const FieldDispatchEntry *findSparse(int fieldNumber) const;
+
+    std::vector<FieldDispatchEntry> m_fields;
+    std::vector<int> m_dense;
+};
+
 //###########################################################################
 //                             Common functions
 //###########################################################################
 
+/*! \brief Calculates size of encoded property field index and its type
+ *
+ * \param fieldIndex The index of a property in parent object
+ * \param wireType Serialization type used for the property with index @p fieldIndex
+ *
+ * \return Number of bytes required for varint encoded fieldIndex and wireType
+ */
+inline qsizetype QProtobufSerializerPrivate::headerSize(int fieldIndex, WireTypes wireType)
+{
+    uint32_t header = (fieldIndex << 3) | wireType;
+    return varintSize(header);
+}
+
 /*! \brief Encode a property field index and its type into output bytes
  *
  * \details
@@ -468,13 +832,12 @@ private:
  *  bit number | 7  6  5  4  3 | 2  1  0
  * \param fieldIndex The index of a property in parent object
  * \param wireType Serialization type used for the property with index @p fieldIndex
- *
- * \return Varint encoded fieldIndex and wireType
+ * \param out Buffer varint encoded fieldIndex and wireType are appended to
  */
-inline QByteArray QProtobufSerializerPrivate::encodeHeader(int fieldIndex, WireTypes wireType)
+inline void QProtobufSerializerPrivate::writeHeader(int fieldIndex, WireTypes wireType, QByteArray &out)
 {
     uint32_t header = (fieldIndex << 3) | wireType;
-    return serializeVarintCommon<uint32_t>(header);
+    writeVarint(header, out);
 }
 
 /*! \brief Decode a property field index and its serialization type from input bytes
@@ -35,6 +35,9 @@
 #include <QPluginLoader>
 #include <QJsonObject>
 #include <QJsonArray>
+#include <QMutex>
+
+#include <stdexcept>
 
 namespace {
 const QLatin1String TypeNames("types");
@@ -72,6 +75,28 @@ struct QProtobufSerializerRegistryPrivateRecord final
         delete loader;
     }
 
+    std::shared_ptr<QAbstractProtobufSerializer> createSerializer(const QString &id)
+    {
+        std::shared_ptr<QAbstractProtobufSerializer> serializer;
+        if (loader == nullptr) {
+            if (id == ProtobufSerializer) {
+                serializer = std::make_shared<QProtobufSerializer>();
+            } else if (id == JsonSerializer) {
+                serializer = std::make_shared<QProtobufJsonSerializer>();
+            }
+        } else if (typeArray.contains(id)) {
+            auto loadedPlugin = qobject_cast<QProtobufSerializationPluginInterface*>(loader->instance());
+            if (loadedPlugin != nullptr) {
+                serializer = loadedPlugin->serializer(id);
+            }
+        }
+
+        if (!serializer) {
+            throw std::out_of_range("Serializer is not provided by plugin");
+        }
+        return serializer;
+    }
+
     void createDefaultImpl()
     {
         if (serializers.find(ProtobufSerializer) == serializers.end()) {
@@ -153,6 +178,7 @@ public:
         plugin->loadPluginMetadata(libPath);
 
         const QString &pluginName = plugin->pluginLoadedName;
+        QMutexLocker locker(&m_pluginsLock);
         if (m_plugins.find(pluginName) == m_plugins.end()) {
             plugin->loadPlugin();
             m_plugins[pluginName] = plugin;
@@ -164,7 +190,38 @@ public:
     }
 
 
+    std::shared_ptr<QAbstractProtobufSerializer> acquireSerializer(const QString &id, const QString &pluginName)
+    {
+        //Serializers are cached per thread, so lock is taken only when thread acquires serializer first time
+        thread_local std::unordered_map<QString, std::shared_ptr<QAbstractProtobufSerializer>> threadSerializers;
+        const QString key = pluginName + QLatin1Char('/') + id;
+        auto it = threadSerializers.find(key);
+        if (it != threadSerializers.end()) {
+            return it->second;
+        }
+
+        std::shared_ptr<QProtobufSerializerRegistryPrivateRecord> record = plugin(pluginName);
+        if (!record) {
+            throw std::out_of_range("Serializer plugin is not loaded");
+        }
+        auto serializer = record->createSerializer(id);
+        threadSerializers[key] = serializer;
+        return serializer;
+    }
+
+    /*
+     * Returns record of loaded plugin or nullptr, if plugin is not loaded. Records are not modified after they are
+     * added, so record may be used without lock.
+     */
+    std::shared_ptr<QProtobufSerializerRegistryPrivateRecord> plugin(const QString &pluginName)
+    {
+        QMutexLocker locker(&m_pluginsLock);
+        auto it = m_plugins.find(pluginName);
+        return it != m_plugins.end() ? it->second : nullptr;
+    }
+
     std::unordered_map<QString/*pluginName*/, std::shared_ptr<QProtobufSerializerRegistryPrivateRecord>> m_plugins;
+    QMutex m_pluginsLock;
     QString m_pluginPath;
 };
 
@@ -186,26 +243,33 @@ QString QProtobufSerializerRegistry::loadPlugin(const QString &name)
 
 std::shared_ptr<QAbstractProtobufSerializer> QProtobufSerializerRegistry::getSerializer(const QString &id)
 {
-    return dPtr->m_plugins[DefaultImpl]->serializers.at(id); //throws
+    return getSerializer(id, DefaultImpl);
 }
 
 std::shared_ptr<QAbstractProtobufSerializer> QProtobufSerializerRegistry::getSerializer(const QString &id, const QString &plugin)
 {
-    return dPtr->m_plugins[plugin]->serializers.at(id); //throws
+    std::shared_ptr<QProtobufSerializerRegistryPrivateRecord> implementation = dPtr->plugin(plugin);
+    if (!implementation) {
+        throw std::out_of_range("Serializer plugin is not loaded");
+    }
+    return implementation->serializers.at(id); //throws
 }
 
-std::unique_ptr<QAbstractProtobufSerializer> QProtobufSerializerRegistry::acquireSerializer(const QString &/*id*/, const QString &/*plugin*/)
+std::shared_ptr<QAbstractProtobufSerializer> QProtobufSerializerRegistry::acquireSerializer(const QString &id)
 {
-    Q_ASSERT_X(false, "QProtobufSerializerRegistry", "acquireSerializer is unimplemented");
-    return std::unique_ptr<QAbstractProtobufSerializer>();
+    return dPtr->acquireSerializer(id, DefaultImpl);
+}
+
+std::shared_ptr<QAbstractProtobufSerializer> QProtobufSerializerRegistry::acquireSerializer(const QString &id, const QString &plugin)
+{
+    return dPtr->acquireSerializer(id, plugin);
 }
 
 float QProtobufSerializerRegistry::pluginVersion(const QString &plugin)
 {
-    if (dPtr->m_plugins.find(plugin) == dPtr->m_plugins.end())
+    std::shared_ptr<QProtobufSerializerRegistryPrivateRecord> implementation = dPtr->plugin(plugin);
+    if (!implementation)
         return 0.0;
-
-    std::shared_ptr<QProtobufSerializerRegistryPrivateRecord> implementation = dPtr->m_plugins[plugin];
     if (implementation->metaData.isEmpty())
         return 0.0;
 
@@ -216,11 +280,10 @@ QStringList QProtobufSerializerRegistry::pluginSerializers(const QString &plugin
 {
     QStringList strList;
 
-    if (dPtr->m_plugins.find(plugin) == dPtr->m_plugins.end())
+    std::shared_ptr<QProtobufSerializerRegistryPrivateRecord> implementation = dPtr->plugin(plugin);
+    if (!implementation)
         return strList;
 
-    std::shared_ptr<QProtobufSerializerRegistryPrivateRecord> implementation = dPtr->m_plugins[plugin];
-
     QVariantList typeArray = implementation->metaData.value(TypeNames).toList();
     foreach(QVariant value, typeArray) {
         if (!value.toString().isEmpty()) {
@@ -232,10 +295,9 @@ QStringList QProtobufSerializerRegistry::pluginSerializers(const QString &plugin
 
 float QProtobufSerializerRegistry::pluginProtobufVersion(const QString &plugin)
 {
-    if (dPtr->m_plugins.find(plugin) == dPtr->m_plugins.end())
+    std::shared_ptr<QProtobufSerializerRegistryPrivateRecord> implementation = dPtr->plugin(plugin);
+    if (!implementation)
         return 0.0;
-
-    std::shared_ptr<QProtobufSerializerRegistryPrivateRecord> implementation = dPtr->m_plugins[plugin];
     if (implementation.get() && implementation->metaData.isEmpty())
         return 0.0;
 
@@ -244,10 +306,9 @@ float QProtobufSerializerRegistry::pluginProtobufVersion(const QString &plugin)
 
 int QProtobufSerializerRegistry::pluginRating(const QString &plugin)
 {
-    if (dPtr->m_plugins.find(plugin) == dPtr->m_plugins.end())
+    std::shared_ptr<QProtobufSerializerRegistryPrivateRecord> implementation = dPtr->plugin(plugin);
+    if (!implementation)
         return 0;
-
-    std::shared_ptr<QProtobufSerializerRegistryPrivateRecord> implementation = dPtr->m_plugins[plugin];
     if (implementation->metaData.isEmpty())
         return 0;
 
@@ -55,7 +55,19 @@ class Q_PROTOBUF_EXPORT QProtobufSerializerRegistry final
 public:
     std::shared_ptr<QAbstractProtobufSerializer> getSerializer(const QString &id);
     std::shared_ptr<QAbstractProtobufSerializer> getSerializer(const QString &id, const QString &plugin);
-    std::unique_ptr<QAbstractProtobufSerializer> acquireSerializer(const QString &id, const QString &plugin);
+
+    /*!
+     * \brief Returns serializer instance that belongs to calling thread
+     *
+     * \details Unlike getSerializer, that returns instance shared between all threads, serializer is
+     *          requested once per thread and is released when thread finishes. Built-in serializers are
+     *          created per thread. Serializer of \a plugin is requested using
+     *          QProtobufSerializationPluginInterface::serializer, so it's per thread only if plugin creates
+     *          new instance on each call, otherwise instance is shared between threads. Throws
+     *          std::out_of_range if \a plugin is not loaded or doesn't provide serializer \a id.
+     */
+    std::shared_ptr<QAbstractProtobufSerializer> acquireSerializer(const QString &id);
+    std::shared_ptr<QAbstractProtobufSerializer> acquireSerializer(const QString &id, const QString &plugin);
     float pluginVersion(const QString &plugin);
     QStringList pluginSerializers(const QString &plugin);
     float pluginProtobufVersion(const QString &plugin);
@@ -0,0 +1,449 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+
+#include "qprotobufstreamparser.h"
+#include "qprotobufserializer.h"
+#include "qprotobufserializer_p.h"
+#include "qprotobufpackedcodec_p.h"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace QtProtobuf {
+
+//! \private
+class QProtobufStreamParserPrivate final
+{
+public:
+    using FieldDispatchEntry = QProtobufSerializerPrivate::FieldDispatchEntry;
+
+    /*!
+     * \private
+     * \brief Length-delimited field that is being received
+     *
+     * \details Message frame accumulates property values of nested message, that are written to the message
+     *          when frame is complete. Value frames accumulate payload of bytes and string fields, and elements
+     *          of packed lists, without buffering of received data.
+     */
+    struct Frame {
+        enum Kind {
+            Message,
+            Bytes,
+            Packed
+        };
+
+        Kind kind = Message;
+        qsizetype remaining = -1; /*!< payload bytes that are not received yet, -1 for top-level message */
+        const FieldDispatchEntry *field = nullptr; /*!< field of enclosing message, that frame is assigned to */
+
+        QObject *object = nullptr;
+        const QProtobufMetaObject *metaObject = nullptr;
+        const QProtobufSerializerPrivate::FieldDispatchTable *table = nullptr;
+        QProtobufUnknownFields *unknownFields = nullptr;
+        QProtobufSerializerPrivate::PropertyValues propertyValues;
+
+        QByteArray bytes;
+        QVariant value;
+    };
+
+    /*!
+     * \private
+     * \brief Header of field and size of its payload
+     */
+    struct FieldInfo {
+        int fieldNumber = QtProtobufPrivate::NotUsedFieldIndex;
+        WireTypes wireType = UnknownWireType;
+        qsizetype headerSize = 0; /*!< size of field header, including length of length-delimited field */
+        qsizetype payloadSize = 0;
+    };
+
+    QProtobufStreamParserPrivate(QObject *object, const QProtobufMetaObject &metaObject) {
+        frames.push_back(messageFrame(object, metaObject, -1, nullptr));
+    }
+
+    static Frame messageFrame(QObject *object, const QProtobufMetaObject &metaObject, qsizetype remaining,
+                              const FieldDispatchEntry *field);
+    static bool peekField(const char *data, qsizetype size, FieldInfo &info);
+    static QVariant &propertyValue(Frame &frame, const FieldDispatchEntry &field);
+    static void writeProperties(Frame &frame);
+
+    bool beginFrame(const FieldDispatchEntry &field, const FieldInfo &info);
+    qsizetype consumeValue(Frame &frame, const char *data, qsizetype size);
+    void endFrame();
+
+    QProtobufSerializer serializer;
+    std::vector<Frame> frames;
+
+    QByteArray pending;
+    qsizetype requiredSize = 0;
+};
+
+}
+
+using namespace QtProtobuf;
+
+namespace {
+/*
+ * Reads varint from the beginning of data. Returns false if data ends before varint is complete
+ */
+bool peekVarint(const char *data, qsizetype size, quint64 &value, qsizetype &length)
+{
+    uint64_t result = 0;
+    const char *next = QProtobufPackedCodec::tryReadVarint(data, data + size, result);
+    if (next == nullptr) {
+        return false;
+    }
+    value = result;
+    length = next - data;
+    return true;
+}
+}
+
+QProtobufStreamParserPrivate::Frame QProtobufStreamParserPrivate::messageFrame(QObject *object,
+                                                                               const QProtobufMetaObject &metaObject,
+                                                                               qsizetype remaining,
+                                                                               const FieldDispatchEntry *field)
+{
+    Frame frame;
+    frame.kind = Frame::Message;
+    frame.remaining = remaining;
+    frame.field = field;
+    frame.object = object;
+    frame.metaObject = &metaObject;
+    frame.table = &metaObject.dispatchTable();
+    frame.unknownFields = metaObject.unknownFields(object);
+    return frame;
+}
+
+/*
+ * Reads header of field at the beginning of data. Returns false if data ends before size of field is known
+ */
+bool QProtobufStreamParserPrivate::peekField(const char *data, qsizetype size, FieldInfo &info)
+{
+    quint64 header = 0;
+    qsizetype headerSize = 0;
+    if (!peekVarint(data, size, header, headerSize)) {
+        return false;
+    }
+
+    info.fieldNumber = static_cast<int>(header >> 3);
+    info.wireType = static_cast<WireTypes>(header & 0x07);
+    info.headerSize = headerSize;
+    switch (info.wireType) {
+    case Varint: {
+        quint64 value = 0;
+        qsizetype valueSize = 0;
+        if (!peekVarint(data + headerSize, size - headerSize, value, valueSize)) {
+            return false;
+        }
+        info.payloadSize = valueSize;
+        return true;
+    }
+    case Fixed32:
+        info.payloadSize = 4;
+        return true;
+    case Fixed64:
+        info.payloadSize = 8;
+        return true;
+    case LengthDelimited: {
+        quint64 length = 0;
+        qsizetype lengthSize = 0;
+        if (!peekVarint(data + headerSize, size - headerSize, length, lengthSize)) {
+            return false;
+        }
+        if (length > static_cast<quint64>(std::numeric_limits<int>::max())) {
+            throw std::out_of_range("Length of field exceeds maximum size of container. Deserialization failed");
+        }
+        info.headerSize += lengthSize;
+        info.payloadSize = static_cast<qsizetype>(length);
+        return true;
+    }
+    default:
+        break;
+    }
+    throw std::invalid_argument("Message received doesn't contains valid header byte. Seems stream is broken");
+}
+
+QVariant &QProtobufStreamParserPrivate::propertyValue(Frame &frame, const FieldDispatchEntry &field)
+{
+    auto it = frame.propertyValues.find(field.propertyIndex);
+    if (it == frame.propertyValues.end()) {
+        it = frame.propertyValues.emplace(field.propertyIndex, field.metaProperty->read(frame.object)).first;
+    }
+    return it->second;
+}
+
+void QProtobufStreamParserPrivate::writeProperties(Frame &frame)
+{
+    for (const auto &propertyValue : frame.propertyValues) {
+        frame.metaObject->staticMetaObject.property(propertyValue.first).write(frame.object, propertyValue.second);
+    }
+    frame.propertyValues.clear();
+}
+
+/*
+ * Starts frame for incomplete length-delimited field of message at the top of stack. Returns false if field
+ * can't be received by parts and has to be buffered
+ */
+bool QProtobufStreamParserPrivate::beginFrame(const FieldDispatchEntry &field, const FieldInfo &info)
+{
+    if (info.wireType != LengthDelimited || field.wireType != LengthDelimited) {
+        return false;
+    }
+
+    Frame frame;
+    frame.remaining = info.payloadSize;
+    frame.field = &field;
+    if (field.packedDecoder != nullptr) {
+        frame.kind = Frame::Packed;
+        frame.value = QVariant(QMetaType(field.userType));
+    } else if (field.userType == QMetaType::QByteArray || field.userType == QMetaType::QString
+               || field.userType == QMetaType::QByteArrayList || field.userType == QMetaType::QStringList) {
+        frame.kind = Frame::Bytes;
+        frame.bytes.reserve(info.payloadSize);
+    } else {
+        //Only singular nested message, that already exists in enclosing message, is received by parts. Elements of
+        //repeated fields and maps are buffered, since they are created by type specific handlers.
+        const QtProtobufPrivate::SerializationHandler &handler = field.handler != nullptr
+                ? *field.handler : QtProtobufPrivate::findHandler(field.userType);
+        if (handler.type != QtProtobufPrivate::ObjectHandler || handler.metaObject == nullptr) {
+            return false;
+        }
+        const QVariant &value = propertyValue(frames.back(), field);
+        if (!(value.metaType().flags() & QMetaType::PointerToQObject)) {
+            return false;
+        }
+        QObject *nested = value.value<QObject *>();
+        if (nested == nullptr) {
+            return false;
+        }
+        frame = messageFrame(nested, *handler.metaObject, info.payloadSize, &field);
+    }
+
+    Frame &parent = frames.back();
+    if (parent.remaining >= 0) {
+        parent.remaining -= info.headerSize + info.payloadSize;
+    }
+    frames.push_back(std::move(frame));
+    return true;
+}
+
+/*
+ * Consumes payload of value frame from data. Returns number of bytes consumed
+ */
+qsizetype QProtobufStreamParserPrivate::consumeValue(Frame &frame, const char *data, qsizetype size)
+{
+    const bool last = size >= frame.remaining;
+    qsizetype consumed = std::min(size, frame.remaining);
+    if (frame.kind == Frame::Bytes) {
+        frame.bytes.append(data, consumed);
+    } else if (!last) {
+        //Only complete elements of packed list are decoded, incomplete element is left in pending data
+        switch (frame.field->packedWireType) {
+        case Fixed32:
+            consumed -= consumed % 4;
+            break;
+        case Fixed64:
+            consumed -= consumed % 8;
+            break;
+        default:
+            while (consumed > 0 && (static_cast<uchar>(data[consumed - 1]) & 0b10000000) != 0) {
+                --consumed;
+            }
+            if (consumed == 0 && size >= QProtobufPackedCodec::MaxVarintSize) {
+                throw std::invalid_argument("Varint is longer than 10 bytes. Deserialization failed");
+            }
+            break;
+        }
+        frame.field->packedDecoder(data, data + consumed, frame.value);
+    } else {
+        frame.field->packedDecoder(data, data + consumed, frame.value);
+    }
+    frame.remaining -= consumed;
+    return consumed;
+}
+
+/*
+ * Completes frame at the top of stack and assigns its value to the field of enclosing message
+ */
+void QProtobufStreamParserPrivate::endFrame()
+{
+    Frame frame = std::move(frames.back());
+    frames.pop_back();
+
+    switch (frame.kind) {
+    case Frame::Message:
+        //Property value of enclosing message already points to the nested message
+        writeProperties(frame);
+        break;
+    case Frame::Packed:
+        frames.back().propertyValues[frame.field->propertyIndex] = std::move(frame.value);
+        break;
+    case Frame::Bytes:
+        switch (frame.field->userType) {
+        case QMetaType::QByteArray:
+            frames.back().propertyValues[frame.field->propertyIndex] = QVariant::fromValue(frame.bytes);
+            break;
+        case QMetaType::QString:
+            frames.back().propertyValues[frame.field->propertyIndex] = QVariant::fromValue(QString::fromUtf8(frame.bytes));
+            break;
+        case QMetaType::QByteArrayList:
+            QtProtobufPrivate::variantContainer<QByteArrayList>(propertyValue(frames.back(), *frame.field)).append(frame.bytes);
+            break;
+        default:
+            QtProtobufPrivate::variantContainer<QStringList>(propertyValue(frames.back(), *frame.field))
+                    .append(QString::fromUtf8(frame.bytes));
+            break;
+        }
+        break;
+    }
+}
+
+QProtobufStreamParser::QProtobufStreamParser(QObject *object, const QProtobufMetaObject &metaObject)
+    : dPtr(new QProtobufStreamParserPrivate(object, metaObject))
+{
+}
+
+QProtobufStreamParser::~QProtobufStreamParser() = default;
+
+void QProtobufStreamParser::feed(const QByteArray &chunk)
+{
+    if (chunk.isEmpty()) {
+        return;
+    }
+
+    //Size of incomplete field is known, wait for the rest of it without parsing
+    if (dPtr->pending.size() + chunk.size() < dPtr->requiredSize) {
+        dPtr->pending.append(chunk);
+        return;
+    }
+
+    QByteArray data;
+    if (dPtr->pending.isEmpty()) {
+        data = chunk;
+    } else {
+        data = std::move(dPtr->pending);
+        data.append(chunk);
+    }
+    dPtr->pending = QByteArray();
+    dPtr->requiredSize = 0;
+
+    using Frame = QProtobufStreamParserPrivate::Frame;
+    QProtobufSerializerPrivate *serializerPrivate = dPtr->serializer.dPtr.get();
+    QProtobufSelfcheckIterator it(data);
+    while (true) {
+        Frame &frame = dPtr->frames.back();
+        if (frame.remaining == 0) {
+            dPtr->endFrame();
+            continue;
+        }
+
+        const qsizetype available = frame.remaining >= 0 ? std::min(qsizetype(it.size()), frame.remaining)
+                                                         : qsizetype(it.size());
+        if (available == 0) {
+            break;
+        }
+
+        if (frame.kind != Frame::Message) {
+            const qsizetype consumed = dPtr->consumeValue(frame, it.data(), available);
+            if (consumed == 0) {
+                break;
+            }
+            it += static_cast<int>(consumed);
+            continue;
+        }
+
+        QProtobufStreamParserPrivate::FieldInfo info;
+        if (!QProtobufStreamParserPrivate::peekField(it.data(), available, info)) {
+            if (available < it.size()) {
+                throw std::out_of_range("Field exceeds size of nested message. Deserialization failed");
+            }
+            break;
+        }
+
+        const qsizetype size = info.headerSize + info.payloadSize;
+        if (frame.remaining >= 0 && size > frame.remaining) {
+            throw std::out_of_range("Field exceeds size of nested message. Deserialization failed");
+        }
+
+        if (size <= available) {
+            QProtobufSelfcheckIterator fieldIt = it.bounded(static_cast<int>(size));
+            serializerPrivate->deserializeProperty(frame.object, *frame.table, fieldIt, frame.propertyValues,
+                                                   frame.unknownFields);
+            it += static_cast<int>(size);
+            if (frame.remaining >= 0) {
+                frame.remaining -= size;
+            }
+            continue;
+        }
+
+        const QProtobufSerializerPrivate::FieldDispatchEntry *field = frame.table->find(info.fieldNumber);
+        if (field == nullptr || !dPtr->beginFrame(*field, info)) {
+            dPtr->requiredSize = size;
+            break;
+        }
+        it += static_cast<int>(info.headerSize);
+    }
+
+    if (it.size() > 0) {
+        //Incomplete data is copied, so buffer is not shared with received data
+        dPtr->pending = QByteArray(it.data(), it.size());
+        if (dPtr->requiredSize > 0) {
+            dPtr->pending.reserve(dPtr->requiredSize);
+        }
+    }
+}
+
+void QProtobufStreamParser::feed(QIODevice *device)
+{
+    Q_ASSERT(device != nullptr);
+    feed(device->readAll());
+}
+
+qsizetype QProtobufStreamParser::pendingBytes() const
+{
+    return dPtr->pending.size();
+}
+
+void QProtobufStreamParser::finish()
+{
+    using Frame = QProtobufStreamParserPrivate::Frame;
+    const bool complete = dPtr->pending.isEmpty() && dPtr->frames.size() == 1;
+
+    //Fields of incomplete nested messages, that are received before, are kept
+    for (auto it = dPtr->frames.rbegin(); it != dPtr->frames.rend(); ++it) {
+        if (it->kind == Frame::Message) {
+            QProtobufStreamParserPrivate::writeProperties(*it);
+        }
+    }
+    dPtr->frames.resize(1);
+    dPtr->pending = QByteArray();
+    dPtr->requiredSize = 0;
+
+    if (!complete) {
+        throw std::out_of_range("Data ends in the middle of field. Deserialization failed");
+    }
+}
@@ -0,0 +1,108 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+
+#pragma once //QProtobufStreamParser
+
+#include <QObject>
+#include <QByteArray>
+#include <QIODevice>
+
+#include <memory>
+
+#include "qtprotobufglobal.h"
+#include "qprotobufmetaobject.h"
+
+namespace QtProtobuf {
+
+class QProtobufStreamParserPrivate;
+
+/*!
+ * \ingroup QtProtobuf
+ * \brief The QProtobufStreamParser class deserializes protobuf binary message from data that arrives by chunks
+ *
+ * \details Each field of the message is deserialized as soon as all its bytes are received, so parsing
+ *          overlaps with data transfer. Parser keeps state across nested length-delimited fields: singular nested
+ *          message, bytes and string fields and packed lists are received by parts, at any nesting level, and
+ *          only incomplete field header or list element is buffered. Elements of repeated message fields and map
+ *          entries are deserialized when they are received completely, so buffer doesn't exceed size of single
+ *          element and chunk.
+ *
+ *          Deserialized field values are accumulated by parser and are written to the message object, when
+ *          finish() is called.
+ *
+ *          Functions throw the same exceptions as QProtobufSerializer::deserialize, if data is malformed.
+ *
+ * \code
+ * ComplexMessage message;
+ * QtProtobuf::QProtobufStreamParser parser(&message);
+ * QObject::connect(reply, &QNetworkReply::readyRead, [&parser, reply] {
+ *     parser.feed(reply);
+ * });
+ * QObject::connect(reply, &QNetworkReply::finished, [&parser] {
+ *     parser.finish();
+ * });
+ * \endcode
+ */
+class Q_PROTOBUF_EXPORT QProtobufStreamParser final
+{
+public:
+    QProtobufStreamParser(QObject *object, const QProtobufMetaObject &metaObject);
+
+    /*!
+     * \brief Constructs parser that deserializes message to \a object of registered qtproto message type T
+     */
+    template<typename T>
+    explicit QProtobufStreamParser(T *object) : QProtobufStreamParser(object, T::protobufMetaObject) {}
+
+    ~QProtobufStreamParser();
+
+    /*!
+     * \brief Deserializes fields, that are completed by \a chunk, and buffers rest of \a chunk
+     */
+    void feed(const QByteArray &chunk);
+
+    /*!
+     * \brief Reads all available data from \a device and passes it to feed
+     */
+    void feed(QIODevice *device);
+
+    /*!
+     * \brief Returns number of received bytes, that are buffered until field or list element is complete
+     */
+    qsizetype pendingBytes() const;
+
+    /*!
+     * \brief Writes deserialized fields to message object and resets parser state
+     *
+     * \details Throws std::out_of_range if data ends in the middle of field. Fields of incomplete nested messages,
+     *          that are received before, are kept.
+     */
+    void finish();
+
+private:
+    Q_DISABLE_COPY_MOVE(QProtobufStreamParser)
+    std::unique_ptr<QProtobufStreamParserPrivate> dPtr;
+};
+
+}
@@ -0,0 +1,118 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once //QProtobufUnknownFields
+
+#include <QByteArray>
+#include <QByteArrayList>
+#include <QObject>
+
+#include "qtprotobufglobal.h"
+
+namespace QtProtobuf {
+
+/*!
+ * \ingroup QtProtobuf
+ * \brief The QProtobufUnknownFields class holds fields of serialized message that are not known to the message type
+ *
+ * \details Each field is stored with its header exactly as it was received. Fields share data with the buffer
+ *          message was deserialized from, so no copy is made while deserializing. Fields are appended to the end
+ *          of the message, when it's serialized, that allows to forward messages without losing fields that were
+ *          added to newer versions of the message.
+ */
+class Q_PROTOBUF_EXPORT QProtobufUnknownFields
+{
+public:
+    QProtobufUnknownFields() = default;
+
+    /*!
+     * \brief Appends serialized \a field, including field header
+     */
+    void append(const QByteArray &field) {
+        m_size += field.size();
+        m_fields.append(field);
+    }
+
+    /*!
+     * \brief Returns list of serialized unknown fields in order they were received
+     */
+    const QByteArrayList &fields() const {
+        return m_fields;
+    }
+
+    bool isEmpty() const {
+        return m_fields.isEmpty();
+    }
+
+    /*!
+     * \brief Returns total size of serialized unknown fields in bytes
+     */
+    qsizetype size() const {
+        return m_size;
+    }
+
+    void clear() {
+        m_fields.clear();
+        m_size = 0;
+    }
+
+    /*!
+     * \brief Appends serialized unknown fields to \a out
+     */
+    void serializeTo(QByteArray &out) const {
+        for (const auto &field : m_fields) {
+            out.append(field);
+        }
+    }
+
+    bool operator ==(const QProtobufUnknownFields &other) const {
+        return m_fields == other.m_fields;
+    }
+
+    bool operator !=(const QProtobufUnknownFields &other) const {
+        return !operator ==(other);
+    }
+
+private:
+    QByteArrayList m_fields;
+    qsizetype m_size = 0;
+};
+
+/*!
+ * \private
+ * \brief Function that returns unknown fields storage of message object
+ */
+using UnknownFieldsAccessor = QProtobufUnknownFields *(*)(QObject *);
+
+/*!
+ * \private
+ * \brief Returns unknown fields storage of message \a object of type T
+ */
+template<typename T>
+QProtobufUnknownFields *unknownFieldsAccessor(QObject *object) {
+    return &(static_cast<T *>(object)->unknownFields());
+}
+
+}
@@ -0,0 +1,681 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "qprotobufwireformat.h"
+#include "qprotobufserializer_p.h"
+
+using namespace QtProtobuf;
+
+namespace {
+thread_local QProtobufWireFormat::SizeCache *currentSizeCache = nullptr;
+}
+
+QProtobufWireFormat::SizeCache::SizeCache() : m_previous(currentSizeCache)
+{
+    currentSizeCache = this;
+}
+
+QProtobufWireFormat::SizeCache::~SizeCache()
+{
+    currentSizeCache = m_previous;
+}
+
+QProtobufWireFormat::SizeCache *QProtobufWireFormat::SizeCache::current()
+{
+    return currentSizeCache;
+}
+
+namespace {
+
+template <typename V>
+void writeBasicField(int fieldNumber, const V &value, WireTypes wireType, QByteArray &out)
+{
+    //Same rules as QProtobufSerializerPrivate::writeProperty uses, default values are always elided
+    if (QProtobufSerializerPrivate::isDefaultValue(value)) {
+        return;
+    }
+    int fieldIndex = fieldNumber;
+    const qsizetype size = QProtobufSerializerPrivate::sizeBasic<V>(value, fieldIndex);
+    if (fieldIndex != QtProtobufPrivate::NotUsedFieldIndex) {
+        QProtobufSerializerPrivate::writeHeader(fieldNumber, wireType, out);
+    }
+    if (size > 0) {
+        QProtobufSerializerPrivate::writeBasic<V>(value, fieldNumber, out);
+    }
+}
+
+template <typename V>
+qsizetype basicFieldSize(int fieldNumber, const V &value, WireTypes wireType)
+{
+    if (QProtobufSerializerPrivate::isDefaultValue(value)) {
+        return 0;
+    }
+    int fieldIndex = fieldNumber;
+    const qsizetype size = QProtobufSerializerPrivate::sizeBasic<V>(value, fieldIndex);
+    if (fieldIndex == QtProtobufPrivate::NotUsedFieldIndex) {
+        return size;
+    }
+    return QProtobufSerializerPrivate::headerSize(fieldNumber, wireType) + size;
+}
+
+template <typename V>
+void writeListField(int fieldNumber, const QList<V> &value, QByteArray &out)
+{
+    int fieldIndex = fieldNumber;
+    const qsizetype size = QProtobufSerializerPrivate::sizeListType<V>(value, fieldIndex);
+    if (fieldIndex != QtProtobufPrivate::NotUsedFieldIndex) {
+        QProtobufSerializerPrivate::writeHeader(fieldNumber, LengthDelimited, out);
+    }
+    if (size > 0) {
+        QProtobufSerializerPrivate::writeListType<V>(value, fieldNumber, out);
+    }
+}
+
+template <typename V>
+qsizetype listFieldSize(int fieldNumber, const QList<V> &value)
+{
+    int fieldIndex = fieldNumber;
+    const qsizetype size = QProtobufSerializerPrivate::sizeListType<V>(value, fieldIndex);
+    if (fieldIndex == QtProtobufPrivate::NotUsedFieldIndex) {
+        return size;
+    }
+    return QProtobufSerializerPrivate::headerSize(fieldNumber, LengthDelimited) + size;
+}
+
+/*!
+ * \private
+ * \brief Writes length-delimited field without size pre-calculation
+ *
+ * \details Size of value is not required to decide if field is written, so strings are encoded straight to
+ *          \a out. Empty values are written too, callers skip default values of singular fields.
+ */
+template <typename V>
+void writeLengthDelimitedField(int fieldNumber, const V &value, QByteArray &out)
+{
+    QProtobufSerializerPrivate::writeHeader(fieldNumber, LengthDelimited, out);
+    QProtobufSerializerPrivate::writeLengthDelimited(value, out);
+}
+
+template <typename V>
+V readZigZag(QProtobufSelfcheckIterator &it)
+{
+    using UV = typename std::make_unsigned<V>::type;
+    const UV unsignedValue = QProtobufSerializerPrivate::deserializeVarintCommon<UV>(it);
+    return (unsignedValue >> 1) ^ (~(unsignedValue & 1) + 1);
+}
+
+template <typename V>
+void readFixed(QProtobufSelfcheckIterator &it, V &value)
+{
+    if (it.size() < static_cast<int>(sizeof(V))) {
+        throw std::out_of_range("Container is less than required fields number. Deserialization failed");
+    }
+    QProtobufPackedCodec::readFixed(it.data(), &value, 1);
+    it += sizeof(V);
+}
+
+template <typename V>
+void readPackedList(QProtobufSelfcheckIterator &it, QList<V> &value)
+{
+    QVariant list;
+    QProtobufSerializerPrivate::deserializeList<V>(it, list);
+    if (value.isEmpty()) {
+        value = list.value<QList<V>>();
+    } else {
+        value.append(list.value<QList<V>>());
+    }
+}
+
+}
+
+void QProtobufWireFormat::writeField(int fieldNumber, int32 value, QByteArray &out)
+{
+    writeBasicField(fieldNumber, value, Varint, out);
+}
+
+void QProtobufWireFormat::writeField(int fieldNumber, int64 value, QByteArray &out)
+{
+    writeBasicField(fieldNumber, value, Varint, out);
+}
+
+void QProtobufWireFormat::writeField(int fieldNumber, sint32 value, QByteArray &out)
+{
+    writeBasicField(fieldNumber, value, Varint, out);
+}
+
+void QProtobufWireFormat::writeField(int fieldNumber, sint64 value, QByteArray &out)
+{
+    writeBasicField(fieldNumber, value, Varint, out);
+}
+
+void QProtobufWireFormat::writeField(int fieldNumber, uint32 value, QByteArray &out)
+{
+    writeBasicField(fieldNumber, value, Varint, out);
+}
+
+void QProtobufWireFormat::writeField(int fieldNumber, uint64 value, QByteArray &out)
+{
+    writeBasicField(fieldNumber, value, Varint, out);
+}
+
+void QProtobufWireFormat::writeField(int fieldNumber, fixed32 value, QByteArray &out)
+{
+    writeBasicField(fieldNumber, value, Fixed32, out);
+}
+
+void QProtobufWireFormat::writeField(int fieldNumber, fixed64 value, QByteArray &out)
+{
+    writeBasicField(fieldNumber, value, Fixed64, out);
+}
+
+void QProtobufWireFormat::writeField(int fieldNumber, sfixed32 value, QByteArray &out)
+{
+    writeBasicField(fieldNumber, value, Fixed32, out);
+}
+
+void QProtobufWireFormat::writeField(int fieldNumber, sfixed64 value, QByteArray &out)
+{
+    writeBasicField(fieldNumber, value, Fixed64, out);
+}
+
+void QProtobufWireFormat::writeField(int fieldNumber, float value, QByteArray &out)
+{
+    writeBasicField(fieldNumber, value, Fixed32, out);
+}
+
+void QProtobufWireFormat::writeField(int fieldNumber, double value, QByteArray &out)
+{
+    writeBasicField(fieldNumber, value, Fixed64, out);
+}
+
+void QProtobufWireFormat::writeField(int fieldNumber, bool value, QByteArray &out)
+{
+    //bool is handled as uint32 by QProtobufSerializer
+    writeBasicField(fieldNumber, static_cast<uint32>(value), Varint, out);
+}
+
+void QProtobufWireFormat::writeField(int fieldNumber, const QString &value, QByteArray &out)
+{
+    if (!value.isEmpty()) {
+        writeLengthDelimitedField(fieldNumber, value, out);
+    }
+}
+
+void QProtobufWireFormat::writeField(int fieldNumber, const QByteArray &value, QByteArray &out)
+{
+    if (!value.isEmpty()) {
+        writeLengthDelimitedField(fieldNumber, value, out);
+    }
+}
+
+void QProtobufWireFormat::writeField(int fieldNumber, const QProtobufLazyString &value, QByteArray &out)
+{
+    if (!value.hasUtf8()) {
+        writeField(fieldNumber, value.toString(), out);
+        return;
+    }
+    writeField(fieldNumber, value.utf8(), out);
+}
+
+void QProtobufWireFormat::writeField(int fieldNumber, const int32List &value, QByteArray &out)
+{
+    writeListField(fieldNumber, value, out);
+}
+
+void QProtobufWireFormat::writeField(int fieldNumber, const int64List &value, QByteArray &out)
+{
+    writeListField(fieldNumber, value, out);
+}
+
+void QProtobufWireFormat::writeField(int fieldNumber, const sint32List &value, QByteArray &out)
+{
+    writeListField(fieldNumber, value, out);
+}
+
+void QProtobufWireFormat::writeField(int fieldNumber, const sint64List &value, QByteArray &out)
+{
+    writeListField(fieldNumber, value, out);
+}
+
+void QProtobufWireFormat::writeField(int fieldNumber, const uint32List &value, QByteArray &out)
+{
+    writeListField(fieldNumber, value, out);
+}
+
+void QProtobufWireFormat::writeField(int fieldNumber, const uint64List &value, QByteArray &out)
+{
+    writeListField(fieldNumber, value, out);
+}
+
+void QProtobufWireFormat::writeField(int fieldNumber, const fixed32List &value, QByteArray &out)
+{
+    writeListField(fieldNumber, value, out);
+}
+
+void QProtobufWireFormat::writeField(int fieldNumber, const fixed64List &value, QByteArray &out)
+{
+    writeListField(fieldNumber, value, out);
+}
+
+void QProtobufWireFormat::writeField(int fieldNumber, const sfixed32List &value, QByteArray &out)
+{
+    writeListField(fieldNumber, value, out);
+}
+
+void QProtobufWireFormat::writeField(int fieldNumber, const sfixed64List &value, QByteArray &out)
+{
+    writeListField(fieldNumber, value, out);
+}
+
+void QProtobufWireFormat::writeField(int fieldNumber, const FloatList &value, QByteArray &out)
+{
+    writeListField(fieldNumber, value, out);
+}
+
+void QProtobufWireFormat::writeField(int fieldNumber, const DoubleList &value, QByteArray &out)
+{
+    writeListField(fieldNumber, value, out);
+}
+
+void QProtobufWireFormat::writeField(int fieldNumber, const QStringList &value, QByteArray &out)
+{
+    //Each element has own header, empty elements are written too
+    for (const auto &element : value) {
+        writeLengthDelimitedField(fieldNumber, element, out);
+    }
+}
+
+void QProtobufWireFormat::writeField(int fieldNumber, const QByteArrayList &value, QByteArray &out)
+{
+    for (const auto &element : value) {
+        writeLengthDelimitedField(fieldNumber, element, out);
+    }
+}
+
+void QProtobufWireFormat::writeHeader(int fieldNumber, WireTypes wireType, QByteArray &out)
+{
+    QProtobufSerializerPrivate::writeHeader(fieldNumber, wireType, out);
+}
+
+void QProtobufWireFormat::writeLength(qsizetype size, QByteArray &out)
+{
+    QProtobufSerializerPrivate::writeVarint(static_cast<uint32_t>(size), out);
+}
+
+qsizetype QProtobufWireFormat::fieldSize(int fieldNumber, int32 value)
+{
+    return basicFieldSize(fieldNumber, value, Varint);
+}
+
+qsizetype QProtobufWireFormat::fieldSize(int fieldNumber, int64 value)
+{
+    return basicFieldSize(fieldNumber, value, Varint);
+}
+
+qsizetype QProtobufWireFormat::fieldSize(int fieldNumber, sint32 value)
+{
+    return basicFieldSize(fieldNumber, value, Varint);
+}
+
+qsizetype QProtobufWireFormat::fieldSize(int fieldNumber, sint64 value)
+{
+    return basicFieldSize(fieldNumber, value, Varint);
+}
+
+qsizetype QProtobufWireFormat::fieldSize(int fieldNumber, uint32 value)
+{
+    return basicFieldSize(fieldNumber, value, Varint);
+}
+
+qsizetype QProtobufWireFormat::fieldSize(int fieldNumber, uint64 value)
+{
+    return basicFieldSize(fieldNumber, value, Varint);
+}
+
+qsizetype QProtobufWireFormat::fieldSize(int fieldNumber, fixed32 value)
+{
+    return basicFieldSize(fieldNumber, value, Fixed32);
+}
+
+qsizetype QProtobufWireFormat::fieldSize(int fieldNumber, fixed64 value)
+{
+    return basicFieldSize(fieldNumber, value, Fixed64);
+}
+
+qsizetype QProtobufWireFormat::fieldSize(int fieldNumber, sfixed32 value)
+{
+    return basicFieldSize(fieldNumber, value, Fixed32);
+}
+
+qsizetype QProtobufWireFormat::fieldSize(int fieldNumber, sfixed64 value)
+{
+    return basicFieldSize(fieldNumber, value, Fixed64);
+}
+
+qsizetype QProtobufWireFormat::fieldSize(int fieldNumber, float value)
+{
+    return basicFieldSize(fieldNumber, value, Fixed32);
+}
+
+qsizetype QProtobufWireFormat::fieldSize(int fieldNumber, double value)
+{
+    return basicFieldSize(fieldNumber, value, Fixed64);
+}
+
+qsizetype QProtobufWireFormat::fieldSize(int fieldNumber, bool value)
+{
+    return basicFieldSize(fieldNumber, static_cast<uint32>(value), Varint);
+}
+
+qsizetype QProtobufWireFormat::fieldSize(int fieldNumber, const QString &value)
+{
+    if (value.isEmpty()) {
+        return 0;
+    }
+    return QProtobufSerializerPrivate::headerSize(fieldNumber, LengthDelimited)
+            + QProtobufSerializerPrivate::lengthDelimitedSize(value);
+}
+
+qsizetype QProtobufWireFormat::fieldSize(int fieldNumber, const QByteArray &value)
+{
+    if (value.isEmpty()) {
+        return 0;
+    }
+    return lengthDelimitedFieldSize(fieldNumber, value.size());
+}
+
+qsizetype QProtobufWireFormat::fieldSize(int fieldNumber, const QProtobufLazyString &value)
+{
+    if (!value.hasUtf8()) {
+        return fieldSize(fieldNumber, value.toString());
+    }
+    return fieldSize(fieldNumber, value.utf8());
+}
+
+qsizetype QProtobufWireFormat::fieldSize(int fieldNumber, const int32List &value)
+{
+    return listFieldSize(fieldNumber, value);
+}
+
+qsizetype QProtobufWireFormat::fieldSize(int fieldNumber, const int64List &value)
+{
+    return listFieldSize(fieldNumber, value);
+}
+
+qsizetype QProtobufWireFormat::fieldSize(int fieldNumber, const sint32List &value)
+{
+    return listFieldSize(fieldNumber, value);
+}
+
+qsizetype QProtobufWireFormat::fieldSize(int fieldNumber, const sint64List &value)
+{
+    return listFieldSize(fieldNumber, value);
+}
+
+qsizetype QProtobufWireFormat::fieldSize(int fieldNumber, const uint32List &value)
+{
+    return listFieldSize(fieldNumber, value);
+}
+
+qsizetype QProtobufWireFormat::fieldSize(int fieldNumber, const uint64List &value)
+{
+    return listFieldSize(fieldNumber, value);
+}
+
+qsizetype QProtobufWireFormat::fieldSize(int fieldNumber, const fixed32List &value)
+{
+    return listFieldSize(fieldNumber, value);
+}
+
+qsizetype QProtobufWireFormat::fieldSize(int fieldNumber, const fixed64List &value)
+{
+    return listFieldSize(fieldNumber, value);
+}
+
+qsizetype QProtobufWireFormat::fieldSize(int fieldNumber, const sfixed32List &value)
+{
+    return listFieldSize(fieldNumber, value);
+}
+
+qsizetype QProtobufWireFormat::fieldSize(int fieldNumber, const sfixed64List &value)
+{
+    return listFieldSize(fieldNumber, value);
+}
+
+qsizetype QProtobufWireFormat::fieldSize(int fieldNumber, const FloatList &value)
+{
+    return listFieldSize(fieldNumber, value);
+}
+
+qsizetype QProtobufWireFormat::fieldSize(int fieldNumber, const DoubleList &value)
+{
+    return listFieldSize(fieldNumber, value);
+}
+
+qsizetype QProtobufWireFormat::fieldSize(int fieldNumber, const QStringList &value)
+{
+    const qsizetype header = QProtobufSerializerPrivate::headerSize(fieldNumber, LengthDelimited);
+    qsizetype size = 0;
+    for (const auto &element : value) {
+        size += header + QProtobufSerializerPrivate::lengthDelimitedSize(element);
+    }
+    return size;
+}
+
+qsizetype QProtobufWireFormat::fieldSize(int fieldNumber, const QByteArrayList &value)
+{
+    qsizetype size = 0;
+    for (const auto &element : value) {
+        size += lengthDelimitedFieldSize(fieldNumber, element.size());
+    }
+    return size;
+}
+
+qsizetype QProtobufWireFormat::lengthDelimitedFieldSize(int fieldNumber, qsizetype size)
+{
+    return QProtobufSerializerPrivate::headerSize(fieldNumber, LengthDelimited)
+            + QProtobufSerializerPrivate::varintSize(static_cast<uint32_t>(size)) + size;
+}
+
+qsizetype QProtobufWireFormat::varintSize(uint64_t value)
+{
+    return QProtobufSerializerPrivate::varintSize(value);
+}
+
+void QProtobufWireFormat::readHeader(QProtobufSelfcheckIterator &it, int &fieldNumber, WireTypes &wireType)
+{
+    if (!QProtobufSerializerPrivate::decodeHeader(it, fieldNumber, wireType)) {
+        throw std::invalid_argument("Message received doesn't contains valid header byte. "
+                              "Seems stream is broken");
+    }
+}
+
+void QProtobufWireFormat::skipField(QProtobufSelfcheckIterator &it, WireTypes wireType)
+{
+    QProtobufSerializerPrivate::skipSerializedFieldBytes(it, wireType);
+}
+
+void QProtobufWireFormat::readUnknownField(QProtobufSelfcheckIterator &it, const char *fieldBegin, WireTypes wireType,
+                                           QProtobufUnknownFields &unknownFields)
+{
+    QProtobufSerializerPrivate::skipSerializedFieldBytes(it, wireType);
+    unknownFields.append(QProtobufSerializerPrivate::sharedData(it.container(), fieldBegin,
+                                                                static_cast<int>(it.data() - fieldBegin)));
+}
+
+void QProtobufWireFormat::readField(QProtobufSelfcheckIterator &it, int32 &value)
+{
+    value = static_cast<int32_t>(QProtobufSerializerPrivate::deserializeVarintCommon<uint32_t>(it));
+}
+
+void QProtobufWireFormat::readField(QProtobufSelfcheckIterator &it, int64 &value)
+{
+    value = static_cast<int64_t>(QProtobufSerializerPrivate::deserializeVarintCommon<uint64_t>(it));
+}
+
+void QProtobufWireFormat::readField(QProtobufSelfcheckIterator &it, sint32 &value)
+{
+    value = readZigZag<sint32>(it);
+}
+
+void QProtobufWireFormat::readField(QProtobufSelfcheckIterator &it, sint64 &value)
+{
+    value = readZigZag<sint64>(it);
+}
+
+void QProtobufWireFormat::readField(QProtobufSelfcheckIterator &it, uint32 &value)
+{
+    value = QProtobufSerializerPrivate::deserializeVarintCommon<uint32>(it);
+}
+
+void QProtobufWireFormat::readField(QProtobufSelfcheckIterator &it, uint64 &value)
+{
+    value = QProtobufSerializerPrivate::deserializeVarintCommon<uint64>(it);
+}
+
+void QProtobufWireFormat::readField(QProtobufSelfcheckIterator &it, fixed32 &value)
+{
+    readFixed(it, value);
+}
+
+void QProtobufWireFormat::readField(QProtobufSelfcheckIterator &it, fixed64 &value)
+{
+    readFixed(it, value);
+}
+
+void QProtobufWireFormat::readField(QProtobufSelfcheckIterator &it, sfixed32 &value)
+{
+    readFixed(it, value);
+}
+
+void QProtobufWireFormat::readField(QProtobufSelfcheckIterator &it, sfixed64 &value)
+{
+    readFixed(it, value);
+}
+
+void QProtobufWireFormat::readField(QProtobufSelfcheckIterator &it, float &value)
+{
+    readFixed(it, value);
+}
+
+void QProtobufWireFormat::readField(QProtobufSelfcheckIterator &it, double &value)
+{
+    readFixed(it, value);
+}
+
+void QProtobufWireFormat::readField(QProtobufSelfcheckIterator &it, bool &value)
+{
+    value = QProtobufSerializerPrivate::deserializeVarintCommon<uint64_t>(it) != 0;
+}
+
+void QProtobufWireFormat::readField(QProtobufSelfcheckIterator &it, QString &value)
+{
+    value = QProtobufSerializerPrivate::deserializeString(it);
+}
+
+void QProtobufWireFormat::readField(QProtobufSelfcheckIterator &it, QProtobufLazyString &value)
+{
+    value = QProtobufLazyString::fromUtf8(QProtobufSerializerPrivate::deserializeLengthDelimited(it));
+}
+
+void QProtobufWireFormat::readField(QProtobufSelfcheckIterator &it, QByteArray &value)
+{
+    value = QProtobufSerializerPrivate::deserializeLengthDelimited(it);
+}
+
+void QProtobufWireFormat::readField(QProtobufSelfcheckIterator &it, int32List &value)
+{
+    readPackedList(it, value);
+}
+
+void QProtobufWireFormat::readField(QProtobufSelfcheckIterator &it, int64List &value)
+{
+    readPackedList(it, value);
+}
+
+void QProtobufWireFormat::readField(QProtobufSelfcheckIterator &it, sint32List &value)
+{
+    readPackedList(it, value);
+}
+
+void QProtobufWireFormat::readField(QProtobufSelfcheckIterator &it, sint64List &value)
+{
+    readPackedList(it, value);
+}
+
+void QProtobufWireFormat::readField(QProtobufSelfcheckIterator &it, uint32List &value)
+{
+    readPackedList(it, value);
+}
+
+void QProtobufWireFormat::readField(QProtobufSelfcheckIterator &it, uint64List &value)
+{
+    readPackedList(it, value);
+}
+
+void QProtobufWireFormat::readField(QProtobufSelfcheckIterator &it, fixed32List &value)
+{
+    readPackedList(it, value);
+}
+
+void QProtobufWireFormat::readField(QProtobufSelfcheckIterator &it, fixed64List &value)
+{
+    readPackedList(it, value);
+}
+
+void QProtobufWireFormat::readField(QProtobufSelfcheckIterator &it, sfixed32List &value)
+{
+    readPackedList(it, value);
+}
+
+void QProtobufWireFormat::readField(QProtobufSelfcheckIterator &it, sfixed64List &value)
+{
+    readPackedList(it, value);
+}
+
+void QProtobufWireFormat::readField(QProtobufSelfcheckIterator &it, FloatList &value)
+{
+    readPackedList(it, value);
+}
+
+void QProtobufWireFormat::readField(QProtobufSelfcheckIterator &it, DoubleList &value)
+{
+    readPackedList(it, value);
+}
+
+void QProtobufWireFormat::readField(QProtobufSelfcheckIterator &it, QStringList &value)
+{
+    value.append(QProtobufSerializerPrivate::deserializeString(it));
+}
+
+void QProtobufWireFormat::readField(QProtobufSelfcheckIterator &it, QByteArrayList &value)
+{
+    value.append(QProtobufSerializerPrivate::deserializeLengthDelimited(it));
+}
+
+QProtobufSelfcheckIterator QProtobufWireFormat::readLengthDelimited(QProtobufSelfcheckIterator &it)
+{
+    return QProtobufSerializerPrivate::deserializeLengthDelimitedView(it);
+}
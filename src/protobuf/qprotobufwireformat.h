@@ -0,0 +1,507 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once //QProtobufWireFormat
+
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+#include <QByteArrayList>
+#include <QList>
+
+#include <type_traits>
+#include <vector>
+
+#include "qtprotobuftypes.h"
+#include "qtprotobufglobal.h"
+#include "qprotobufselfcheckiterator.h"
+#include "qprotobufunknownfields.h"
+#include "qprotobuflazymessagepointer.h"
+#include "qprotobuflazystring.h"
+
+namespace QtProtobuf {
+
+/*!
+ * \ingroup QtProtobuf
+ * \brief The QProtobufWireFormat class contains typed protobuf binary wire format primitives
+ *
+ * \details Functions are used by messages generated with DIRECT_SERIALIZATION option. Generated serializeTo and
+ *          parseFrom methods access message fields directly and encode them using this class, without meta-property
+ *          lookups, QVariant boxing and serialization handlers. Encoding rules are the same as in QProtobufSerializer:
+ *          fields that hold proto3 default values and empty repeated fields are not written.
+ */
+class Q_PROTOBUF_EXPORT QProtobufWireFormat final
+{
+public:
+    QProtobufWireFormat() = delete;
+
+    /*!
+     * \brief Sizes of nested messages calculated by messageSize, reused by writeMessage
+     *
+     * \details While object is alive, messageSize stores sizes of nested messages in pre-order and writeMessage
+     *          consumes them in the same order, so serializedSize of nested message is called only once per
+     *          serialization. Cache is installed per thread for the lifetime of object. Without installed cache
+     *          writeMessage installs its own one for the nested message it writes.
+     *
+     * \code
+     * QtProtobuf::QProtobufWireFormat::SizeCache sizes;
+     * out.reserve(out.size() + message.serializedSize());
+     * message.serializeTo(out);
+     * \endcode
+     */
+    class Q_PROTOBUF_EXPORT SizeCache final
+    {
+        Q_DISABLE_COPY_MOVE(SizeCache)
+    public:
+        SizeCache();
+        ~SizeCache();
+
+        //! \private
+        static SizeCache *current();
+
+        //! \private
+        std::size_t reserveSize() {
+            m_sizes.push_back(0);
+            return m_sizes.size() - 1;
+        }
+
+        //! \private
+        void setSize(std::size_t slot, qsizetype size) {
+            m_sizes[slot] = size;
+        }
+
+        //! \private
+        qsizetype nextSize() {
+            Q_ASSERT_X(m_cursor < m_sizes.size(), "QProtobufWireFormat::SizeCache",
+                       "Written nested messages don't match measured nested messages");
+            return m_sizes[m_cursor++];
+        }
+
+    private:
+        SizeCache *m_previous;
+        std::vector<qsizetype> m_sizes;
+        std::size_t m_cursor = 0;
+    };
+
+    static void writeField(int fieldNumber, int32 value, QByteArray &out);
+    static void writeField(int fieldNumber, int64 value, QByteArray &out);
+    static void writeField(int fieldNumber, sint32 value, QByteArray &out);
+    static void writeField(int fieldNumber, sint64 value, QByteArray &out);
+    static void writeField(int fieldNumber, uint32 value, QByteArray &out);
+    static void writeField(int fieldNumber, uint64 value, QByteArray &out);
+    static void writeField(int fieldNumber, fixed32 value, QByteArray &out);
+    static void writeField(int fieldNumber, fixed64 value, QByteArray &out);
+    static void writeField(int fieldNumber, sfixed32 value, QByteArray &out);
+    static void writeField(int fieldNumber, sfixed64 value, QByteArray &out);
+    static void writeField(int fieldNumber, float value, QByteArray &out);
+    static void writeField(int fieldNumber, double value, QByteArray &out);
+    static void writeField(int fieldNumber, bool value, QByteArray &out);
+    static void writeField(int fieldNumber, const QString &value, QByteArray &out);
+    static void writeField(int fieldNumber, const QByteArray &value, QByteArray &out);
+
+    /*!
+     * \brief Writes string \a value
+     *
+     * \details If \a value holds UTF-8 data, it's written as is, without encoding of string.
+     */
+    static void writeField(int fieldNumber, const QProtobufLazyString &value, QByteArray &out);
+
+    static void writeField(int fieldNumber, const int32List &value, QByteArray &out);
+    static void writeField(int fieldNumber, const int64List &value, QByteArray &out);
+    static void writeField(int fieldNumber, const sint32List &value, QByteArray &out);
+    static void writeField(int fieldNumber, const sint64List &value, QByteArray &out);
+    static void writeField(int fieldNumber, const uint32List &value, QByteArray &out);
+    static void writeField(int fieldNumber, const uint64List &value, QByteArray &out);
+    static void writeField(int fieldNumber, const fixed32List &value, QByteArray &out);
+    static void writeField(int fieldNumber, const fixed64List &value, QByteArray &out);
+    static void writeField(int fieldNumber, const sfixed32List &value, QByteArray &out);
+    static void writeField(int fieldNumber, const sfixed64List &value, QByteArray &out);
+    static void writeField(int fieldNumber, const FloatList &value, QByteArray &out);
+    static void writeField(int fieldNumber, const DoubleList &value, QByteArray &out);
+    static void writeField(int fieldNumber, const QStringList &value, QByteArray &out);
+    static void writeField(int fieldNumber, const QByteArrayList &value, QByteArray &out);
+
+    /*!
+     * \brief Writes enum \a value. Enum values are encoded as int64
+     */
+    template <typename T,
+              typename std::enable_if_t<std::is_enum<T>::value, int> = 0>
+    static void writeField(int fieldNumber, T value, QByteArray &out) {
+        writeField(fieldNumber, int64(static_cast<int64_t>(value)), out);
+    }
+
+    /*!
+     * \brief Writes list of enum values as packed int64 list
+     */
+    template <typename T,
+              typename std::enable_if_t<std::is_enum<T>::value, int> = 0>
+    static void writeField(int fieldNumber, const QList<T> &value, QByteArray &out) {
+        if (value.isEmpty()) {
+            return;
+        }
+        int64List intList;
+        intList.reserve(value.size());
+        for (const auto &enumValue : value) {
+            intList.append(static_cast<int64_t>(enumValue));
+        }
+        writeField(fieldNumber, intList, out);
+    }
+
+    /*!
+     * \brief Writes nested message \a value, using its generated serializeTo method
+     *
+     * \details Length is written before the message data, so the data is never moved. Size of \a value is taken
+     *          from the installed SizeCache. Without cache it's calculated once for \a value and all its nested
+     *          messages.
+     */
+    template <typename T>
+    static void writeMessage(int fieldNumber, const T &value, QByteArray &out) {
+        writeHeader(fieldNumber, LengthDelimited, out);
+        if (SizeCache *sizes = SizeCache::current()) {
+            writeLength(sizes->nextSize(), out);
+            value.serializeTo(out);
+            return;
+        }
+        SizeCache sizes;
+        writeLength(value.serializedSize(), out);
+        value.serializeTo(out);
+    }
+
+    /*!
+     * \brief Writes nested message \a value
+     *
+     * \details If message was read with readLazyMessage and was not accessed since then, the original serialized
+     *          data is written as is.
+     */
+    template <typename T>
+    static void writeMessage(int fieldNumber, const QProtobufLazyMessagePointer<T> &value, QByteArray &out) {
+        if (!value.hasSerializedData()) {
+            writeMessage(fieldNumber, *value, out);
+            return;
+        }
+        const QByteArray &data = value.serializedData();
+        writeHeader(fieldNumber, LengthDelimited, out);
+        writeLength(data.size(), out);
+        out.append(data);
+    }
+
+    static void writeHeader(int fieldNumber, WireTypes wireType, QByteArray &out);
+
+    /*!
+     * \brief Writes \a size of length-delimited data, that is appended to \a out next
+     */
+    static void writeLength(qsizetype size, QByteArray &out);
+
+    static qsizetype fieldSize(int fieldNumber, int32 value);
+    static qsizetype fieldSize(int fieldNumber, int64 value);
+    static qsizetype fieldSize(int fieldNumber, sint32 value);
+    static qsizetype fieldSize(int fieldNumber, sint64 value);
+    static qsizetype fieldSize(int fieldNumber, uint32 value);
+    static qsizetype fieldSize(int fieldNumber, uint64 value);
+    static qsizetype fieldSize(int fieldNumber, fixed32 value);
+    static qsizetype fieldSize(int fieldNumber, fixed64 value);
+    static qsizetype fieldSize(int fieldNumber, sfixed32 value);
+    static qsizetype fieldSize(int fieldNumber, sfixed64 value);
+    static qsizetype fieldSize(int fieldNumber, float value);
+    static qsizetype fieldSize(int fieldNumber, double value);
+    static qsizetype fieldSize(int fieldNumber, bool value);
+    static qsizetype fieldSize(int fieldNumber, const QString &value);
+    static qsizetype fieldSize(int fieldNumber, const QByteArray &value);
+    static qsizetype fieldSize(int fieldNumber, const QProtobufLazyString &value);
+    static qsizetype fieldSize(int fieldNumber, const int32List &value);
+    static qsizetype fieldSize(int fieldNumber, const int64List &value);
+    static qsizetype fieldSize(int fieldNumber, const sint32List &value);
+    static qsizetype fieldSize(int fieldNumber, const sint64List &value);
+    static qsizetype fieldSize(int fieldNumber, const uint32List &value);
+    static qsizetype fieldSize(int fieldNumber, const uint64List &value);
+    static qsizetype fieldSize(int fieldNumber, const fixed32List &value);
+    static qsizetype fieldSize(int fieldNumber, const fixed64List &value);
+    static qsizetype fieldSize(int fieldNumber, const sfixed32List &value);
+    static qsizetype fieldSize(int fieldNumber, const sfixed64List &value);
+    static qsizetype fieldSize(int fieldNumber, const FloatList &value);
+    static qsizetype fieldSize(int fieldNumber, const DoubleList &value);
+    static qsizetype fieldSize(int fieldNumber, const QStringList &value);
+    static qsizetype fieldSize(int fieldNumber, const QByteArrayList &value);
+
+    /*!
+     * \brief Returns size of enum field \a value, written by writeField
+     */
+    template <typename T,
+              typename std::enable_if_t<std::is_enum<T>::value, int> = 0>
+    static qsizetype fieldSize(int fieldNumber, T value) {
+        return fieldSize(fieldNumber, int64(static_cast<int64_t>(value)));
+    }
+
+    /*!
+     * \brief Returns size of enum list field \a value, written by writeField
+     */
+    template <typename T,
+              typename std::enable_if_t<std::is_enum<T>::value, int> = 0>
+    static qsizetype fieldSize(int fieldNumber, const QList<T> &value) {
+        if (value.isEmpty()) {
+            return 0;
+        }
+        qsizetype size = 0;
+        for (const auto &enumValue : value) {
+            size += varintSize(static_cast<uint64_t>(static_cast<int64_t>(enumValue)));
+        }
+        return lengthDelimitedFieldSize(fieldNumber, size);
+    }
+
+    /*!
+     * \brief Returns size of nested message field \a value, written by writeMessage
+     */
+    template <typename T>
+    static qsizetype messageSize(int fieldNumber, const T &value) {
+        SizeCache *sizes = SizeCache::current();
+        if (sizes == nullptr) {
+            return lengthDelimitedFieldSize(fieldNumber, value.serializedSize());
+        }
+        //Slot is reserved before nested messages of value store their sizes
+        const std::size_t slot = sizes->reserveSize();
+        const qsizetype size = value.serializedSize();
+        sizes->setSize(slot, size);
+        return lengthDelimitedFieldSize(fieldNumber, size);
+    }
+
+    template <typename T>
+    static qsizetype messageSize(int fieldNumber, const QProtobufLazyMessagePointer<T> &value) {
+        if (!value.hasSerializedData()) {
+            return messageSize(fieldNumber, *value);
+        }
+        return lengthDelimitedFieldSize(fieldNumber, value.serializedData().size());
+    }
+
+    /*!
+     * \brief Returns size of length-delimited field with data of \a size bytes, including header and length
+     */
+    static qsizetype lengthDelimitedFieldSize(int fieldNumber, qsizetype size);
+
+    /*!
+     * \brief Returns number of bytes required for varint encoded \a value
+     */
+    static qsizetype varintSize(uint64_t value);
+
+    /*!
+     * \brief Reads field header
+     *
+     * \details Throws std::invalid_argument if header is invalid.
+     */
+    static void readHeader(QProtobufSelfcheckIterator &it, int &fieldNumber, WireTypes &wireType);
+
+    /*!
+     * \brief Skips field data of unknown field
+     */
+    static void skipField(QProtobufSelfcheckIterator &it, WireTypes wireType);
+
+    /*!
+     * \brief Skips field data of unknown field and stores the field, starting from \a fieldBegin, in \a unknownFields
+     *
+     * \details \a fieldBegin points to the header of the field. Stored field shares data with the input buffer.
+     */
+    static void readUnknownField(QProtobufSelfcheckIterator &it, const char *fieldBegin, WireTypes wireType,
+                                 QProtobufUnknownFields &unknownFields);
+
+    static void readField(QProtobufSelfcheckIterator &it, int32 &value);
+    static void readField(QProtobufSelfcheckIterator &it, int64 &value);
+    static void readField(QProtobufSelfcheckIterator &it, sint32 &value);
+    static void readField(QProtobufSelfcheckIterator &it, sint64 &value);
+    static void readField(QProtobufSelfcheckIterator &it, uint32 &value);
+    static void readField(QProtobufSelfcheckIterator &it, uint64 &value);
+    static void readField(QProtobufSelfcheckIterator &it, fixed32 &value);
+    static void readField(QProtobufSelfcheckIterator &it, fixed64 &value);
+    static void readField(QProtobufSelfcheckIterator &it, sfixed32 &value);
+    static void readField(QProtobufSelfcheckIterator &it, sfixed64 &value);
+    static void readField(QProtobufSelfcheckIterator &it, float &value);
+    static void readField(QProtobufSelfcheckIterator &it, double &value);
+    static void readField(QProtobufSelfcheckIterator &it, bool &value);
+    static void readField(QProtobufSelfcheckIterator &it, QString &value);
+
+    /*!
+     * \brief Reads string \a value, UTF-8 data is decoded on first access to \a value
+     */
+    static void readField(QProtobufSelfcheckIterator &it, QProtobufLazyString &value);
+    static void readField(QProtobufSelfcheckIterator &it, QByteArray &value);
+
+    static void readField(QProtobufSelfcheckIterator &it, int32List &value);
+    static void readField(QProtobufSelfcheckIterator &it, int64List &value);
+    static void readField(QProtobufSelfcheckIterator &it, sint32List &value);
+    static void readField(QProtobufSelfcheckIterator &it, sint64List &value);
+    static void readField(QProtobufSelfcheckIterator &it, uint32List &value);
+    static void readField(QProtobufSelfcheckIterator &it, uint64List &value);
+    static void readField(QProtobufSelfcheckIterator &it, fixed32List &value);
+    static void readField(QProtobufSelfcheckIterator &it, fixed64List &value);
+    static void readField(QProtobufSelfcheckIterator &it, sfixed32List &value);
+    static void readField(QProtobufSelfcheckIterator &it, sfixed64List &value);
+    static void readField(QProtobufSelfcheckIterator &it, FloatList &value);
+    static void readField(QProtobufSelfcheckIterator &it, DoubleList &value);
+    static void readField(QProtobufSelfcheckIterator &it, QStringList &value);
+    static void readField(QProtobufSelfcheckIterator &it, QByteArrayList &value);
+
+    /*!
+     * \brief Reads enum \a value encoded as int64
+     */
+    template <typename T,
+              typename std::enable_if_t<std::is_enum<T>::value, int> = 0>
+    static void readField(QProtobufSelfcheckIterator &it, T &value) {
+        int64 intValue;
+        readField(it, intValue);
+        value = static_cast<T>(intValue._t);
+    }
+
+    /*!
+     * \brief Reads packed list of enum values encoded as int64 and appends them to \a value
+     */
+    template <typename T,
+              typename std::enable_if_t<std::is_enum<T>::value, int> = 0>
+    static void readField(QProtobufSelfcheckIterator &it, QList<T> &value) {
+        int64List intList;
+        readField(it, intList);
+        value.reserve(value.size() + intList.size());
+        for (const auto &intValue : intList) {
+            value.append(static_cast<T>(intValue._t));
+        }
+    }
+
+    /*!
+     * \brief Reads field \a value, that has header with \a wireType
+     *
+     * \return false if \a wireType is not valid for the field type. Field data is not read in this case.
+     */
+    template <typename T>
+    static bool readField(QProtobufSelfcheckIterator &it, WireTypes wireType, T &value) {
+        if (wireType != fieldWireType(value)) {
+            return false;
+        }
+        readField(it, value);
+        return true;
+    }
+
+    /*!
+     * \brief Reads repeated field \a value, that has header with \a wireType
+     *
+     * \details Repeated scalar fields are accepted in both packed and unpacked form, one element is read and appended
+     *          to \a value for unpacked form.
+     * \return false if \a wireType is not valid for the field type. Field data is not read in this case.
+     */
+    template <typename T>
+    static bool readField(QProtobufSelfcheckIterator &it, WireTypes wireType, QList<T> &value) {
+        if (wireType == LengthDelimited) {
+            readField(it, value);
+            return true;
+        }
+        if (wireType != fieldWireType(T{})) {
+            return false;
+        }
+        T element{};
+        readField(it, element);
+        value.append(element);
+        return true;
+    }
+
+    /*!
+     * \brief Reads nested message and merges it to \a value, using its generated parseFrom method
+     */
+    template <typename T>
+    static void readMessage(QProtobufSelfcheckIterator &it, T &value) {
+        QProtobufSelfcheckIterator messageIt = readLengthDelimited(it);
+        value.parseFrom(messageIt);
+    }
+
+    /*!
+     * \brief Reads nested message data and stores it in \a value without parsing
+     *
+     * \details Message is parsed on first access to \a value. Stored data shares memory with the input buffer.
+     *          Errors in nested message data are not reported by this function, message fields that were parsed before
+     *          the error are kept and warning is logged on access.
+     */
+    template <typename T>
+    static void readLazyMessage(QProtobufSelfcheckIterator &it, QProtobufLazyMessagePointer<T> &value) {
+        QByteArray data;
+        readField(it, data);
+        value.appendSerializedData(data, &parseMessageData<T>);
+    }
+
+    /*!
+     * \brief Reads nested message, that has header with \a wireType, and merges it to \a value
+     *
+     * \return false if \a wireType is not LengthDelimited. Field data is not read in this case.
+     */
+    template <typename T>
+    static bool readMessage(QProtobufSelfcheckIterator &it, WireTypes wireType, T &value) {
+        if (wireType != LengthDelimited) {
+            return false;
+        }
+        readMessage(it, value);
+        return true;
+    }
+
+    /*!
+     * \brief Reads nested message data, that has header with \a wireType, and stores it in \a value without parsing
+     *
+     * \return false if \a wireType is not LengthDelimited. Field data is not read in this case.
+     */
+    template <typename T>
+    static bool readLazyMessage(QProtobufSelfcheckIterator &it, WireTypes wireType,
+                                QProtobufLazyMessagePointer<T> &value) {
+        if (wireType != LengthDelimited) {
+            return false;
+        }
+        readLazyMessage(it, value);
+        return true;
+    }
+
+private:
+    static constexpr WireTypes fieldWireType(const int32 &) { return Varint; }
+    static constexpr WireTypes fieldWireType(const int64 &) { return Varint; }
+    static constexpr WireTypes fieldWireType(const sint32 &) { return Varint; }
+    static constexpr WireTypes fieldWireType(const sint64 &) { return Varint; }
+    static constexpr WireTypes fieldWireType(const uint32 &) { return Varint; }
+    static constexpr WireTypes fieldWireType(const uint64 &) { return Varint; }
+    static constexpr WireTypes fieldWireType(const bool &) { return Varint; }
+    static constexpr WireTypes fieldWireType(const fixed32 &) { return Fixed32; }
+    static constexpr WireTypes fieldWireType(const sfixed32 &) { return Fixed32; }
+    static constexpr WireTypes fieldWireType(const float &) { return Fixed32; }
+    static constexpr WireTypes fieldWireType(const fixed64 &) { return Fixed64; }
+    static constexpr WireTypes fieldWireType(const sfixed64 &) { return Fixed64; }
+    static constexpr WireTypes fieldWireType(const double &) { return Fixed64; }
+    static constexpr WireTypes fieldWireType(const QString &) { return LengthDelimited; }
+    static constexpr WireTypes fieldWireType(const QByteArray &) { return LengthDelimited; }
+    static constexpr WireTypes fieldWireType(const QProtobufLazyString &) { return LengthDelimited; }
+
+    template <typename T,
+              typename std::enable_if_t<std::is_enum<T>::value, int> = 0>
+    static constexpr WireTypes fieldWireType(const T &) { return Varint; }
+
+    template <typename T>
+    static void parseMessageData(T &value, const QByteArray &data) {
+        QProtobufSelfcheckIterator it(data);
+        value.parseFrom(it);
+    }
+
+    static QProtobufSelfcheckIterator readLengthDelimited(QProtobufSelfcheckIterator &it);
+};
+
+}
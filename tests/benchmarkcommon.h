@@ -0,0 +1,141 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QList>
+#include <QtEndian>
+#include <QVariant>
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include "qprotobufselfcheckiterator.h"
+#include "qtprotobuftypes.h"
+
+namespace QtProtobuf {
+
+namespace tests {
+
+/*!
+ * \brief Runs \a function \a iterations times and returns elapsed time in nanoseconds
+ */
+template<typename F>
+qint64 measureNsecs(int iterations, F &&function)
+{
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < iterations; ++i) {
+        function();
+    }
+    return timer.nsecsElapsed();
+}
+
+/*!
+ * \brief Reports \a nsecs as \a name property of the current test
+ *
+ * \details Benchmarks don't compare timings, since they depend on the machine and its load. Timings are written to
+ *          the test report and printed.
+ */
+inline void reportTime(const char *name, qint64 nsecs)
+{
+    ::testing::Test::RecordProperty(name, std::to_string(nsecs));
+    std::cout << "[ TIMING   ] " << name << ": " << nsecs << " ns" << std::endl;
+}
+
+/*!
+ * \brief Reference decoding of packed varint list payload, that starts at \a offset in \a data
+ *
+ * \details Every byte is read using checked iterator and every element is boxed to QVariant, same way as it was done
+ *          before varints were decoded with single bounds check.
+ */
+template<typename V>
+QList<V> referenceDecodeVarints(const QByteArray &data, int offset)
+{
+    QList<V> values;
+    QProtobufSelfcheckIterator it(data);
+    it += offset;
+    while (it != data.end()) {
+        uint64_t value = 0;
+        int shift = 0;
+        while ((*it) & 0x80) {
+            value |= (static_cast<uint64_t>(static_cast<uchar>(*it)) & 0x7f) << shift;
+            shift += 7;
+            ++it;
+        }
+        value |= static_cast<uint64_t>(static_cast<uchar>(*it)) << shift;
+        ++it;
+        const QVariant variantValue = QVariant::fromValue<V>(value);
+        values.append(variantValue.value<V>());
+    }
+    return values;
+}
+
+/*!
+ * \brief Reference encoding of fixed-width \a values as packed list payload, element by element
+ *
+ * \details Same way as it was done before packed fixed-width lists were copied in bulk.
+ */
+template<typename V>
+QByteArray referenceEncodeFixed(const QList<V> &values)
+{
+    QByteArray payload;
+    for (V value : values) {
+        const V littleEndianValue = qToLittleEndian(value);
+        payload.append(QByteArray(reinterpret_cast<const char *>(&littleEndianValue), sizeof(V)));
+    }
+    return payload;
+}
+
+/*!
+ * \brief Reference decoding of packed fixed-width list payload, that starts at \a offset in \a data
+ *
+ * \details Elements are copied one by one and boxed to QVariant, same way as it was done before packed fixed-width
+ *          lists were copied in bulk.
+ */
+template<typename V>
+QList<V> referenceDecodeFixed(const QByteArray &data, int offset)
+{
+    QList<V> values;
+    QProtobufSelfcheckIterator it(data);
+    it += offset;
+    while (it != data.end()) {
+        V value;
+        std::memcpy(&value, it.data(), sizeof(V));
+        it += sizeof(V);
+        const QVariant variantValue = QVariant::fromValue(qFromLittleEndian(value));
+        values.append(variantValue.value<V>());
+    }
+    return values;
+}
+
+}
+
+}
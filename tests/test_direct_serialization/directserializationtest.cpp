@@ -0,0 +1,358 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include "directserialization.qpb.h"
+#include "../benchmarkcommon.h"
+
+#include <QProtobufSerializer>
+
+#include <gtest/gtest.h>
+
+#include <memory>
+
+using namespace qtprotobufnamespace::direct::tests;
+
+namespace QtProtobuf {
+namespace tests {
+
+class DirectSerializationTest : public ::testing::Test
+{
+public:
+    DirectSerializationTest() = default;
+
+    void SetUp() override;
+    static void SetUpTestCase();
+
+protected:
+    std::unique_ptr<QProtobufSerializer> serializer;
+};
+
+void DirectSerializationTest::SetUpTestCase()
+{
+    QtProtobuf::qRegisterProtobufTypes();
+}
+
+void DirectSerializationTest::SetUp()
+{
+    serializer.reset(new QProtobufSerializer);
+}
+
+static ScalarMessage createScalarMessage()
+{
+    ScalarMessage msg;
+    msg.setTestFieldInt32(-15);
+    msg.setTestFieldInt64(300);
+    msg.setTestFieldSInt32(-65545);
+    msg.setTestFieldSInt64(INT64_MIN);
+    msg.setTestFieldUInt32(UINT32_MAX);
+    msg.setTestFieldUInt64(UINT64_MAX);
+    msg.setTestFieldFixed32(0x01020304);
+    msg.setTestFieldFixed64(0x0102030405060708);
+    msg.setTestFieldSFixed32(-42);
+    msg.setTestFieldSFixed64(-4200000000);
+    msg.setTestFieldFloat(0.5f);
+    msg.setTestFieldDouble(-1.25);
+    msg.setTestFieldBool(true);
+    msg.setTestFieldString(QString::fromUtf8("Тест string"));
+    msg.setTestFieldBytes(QByteArray::fromHex("00ff10"));
+    msg.setTestFieldEnum(ScalarMessage::LOCAL_ENUM_VALUE2);
+    return msg;
+}
+
+static RepeatedMessage createRepeatedMessage()
+{
+    RepeatedMessage msg;
+    msg.setTestRepeatedInt32({0, 1, 321, -65999, 123245, -3, 3});
+    msg.setTestRepeatedSInt64({INT64_MIN, -1, 0, 1, INT64_MAX});
+    msg.setTestRepeatedFixed32({1, 0, 0xffffffff, 42});
+    msg.setTestRepeatedDouble({0.1, -0.2, 1e10});
+    msg.setTestRepeatedString({"aaa", "", "ccc"});
+    msg.setTestRepeatedBytes({QByteArray::fromHex("0102"), QByteArray(), QByteArray("abc")});
+    msg.setTestRepeatedEnum({RepeatedMessage::LOCAL_ENUM_VALUE1,
+                             RepeatedMessage::LOCAL_ENUM_VALUE0,
+                             RepeatedMessage::LOCAL_ENUM_VALUE2});
+    return msg;
+}
+
+TEST_F(DirectSerializationTest, FieldOrderTest)
+{
+    NestedMessage nested;
+    nested.setTestFieldSInt32(-1);
+    nested.setTestFieldString("ab");
+
+    ComplexMessage msg;
+    msg.setTestFieldInt32(150);
+    msg.setTestComplexField(nested);
+    msg.setTestFieldString("c");
+
+    QByteArray result = msg.serialize(serializer.get());
+    EXPECT_STREQ(result.toHex().toStdString().c_str(), "08960112060801120261621a0163");
+}
+
+TEST_F(DirectSerializationTest, ScalarRoundTripTest)
+{
+    ScalarMessage source = createScalarMessage();
+    QByteArray direct = source.serialize(serializer.get());
+
+    //Generated serialization is decodable by property-based deserialization
+    ScalarMessage reflective;
+    serializer->deserializeMessage(&reflective, ScalarMessage::protobufMetaObject, direct);
+    EXPECT_TRUE(reflective == source);
+
+    //Property-based serialization is decodable by generated deserialization
+    QByteArray reflectiveData = serializer->serializeMessage(&source, ScalarMessage::protobufMetaObject);
+    EXPECT_TRUE(reflectiveData == direct);
+    ScalarMessage test;
+    test.deserialize(serializer.get(), reflectiveData);
+    EXPECT_TRUE(test == source);
+}
+
+TEST_F(DirectSerializationTest, RepeatedRoundTripTest)
+{
+    RepeatedMessage source = createRepeatedMessage();
+    QByteArray direct = source.serialize(serializer.get());
+
+    RepeatedMessage reflective;
+    serializer->deserializeMessage(&reflective, RepeatedMessage::protobufMetaObject, direct);
+    EXPECT_TRUE(reflective == source);
+
+    QByteArray reflectiveData = serializer->serializeMessage(&source, RepeatedMessage::protobufMetaObject);
+    EXPECT_TRUE(reflectiveData == direct);
+    RepeatedMessage test;
+    test.deserialize(serializer.get(), reflectiveData);
+    EXPECT_TRUE(test == source);
+}
+
+TEST_F(DirectSerializationTest, ComplexRoundTripTest)
+{
+    NestedMessage nested;
+    nested.setTestFieldSInt32(-100);
+    nested.setTestFieldString("nested");
+
+    ComplexMessage source;
+    source.setTestFieldInt32(42);
+    source.setTestComplexField(nested);
+    source.setTestFieldString("outer");
+
+    ComplexMessage test;
+    test.deserialize(serializer.get(), source.serialize(serializer.get()));
+    EXPECT_TRUE(test == source);
+    EXPECT_EQ(test.testComplexField().testFieldSInt32(), -100);
+}
+
+TEST_F(DirectSerializationTest, SerializedSizeTest)
+{
+    EXPECT_EQ(createScalarMessage().serializedSize(), createScalarMessage().serialize(serializer.get()).size());
+    EXPECT_EQ(createRepeatedMessage().serializedSize(), createRepeatedMessage().serialize(serializer.get()).size());
+
+    //Length of nested message longer than 127 bytes takes more than one byte
+    NestedMessage nested;
+    nested.setTestFieldSInt32(-100);
+    nested.setTestFieldString(QString(300, QChar('n')));
+
+    ComplexMessage source;
+    source.setTestFieldInt32(42);
+    source.setTestComplexField(nested);
+    source.setTestFieldString("outer");
+
+    const QByteArray direct = source.serialize(serializer.get());
+    EXPECT_EQ(source.serializedSize(), direct.size());
+    EXPECT_TRUE(direct == serializer->serializeMessage(&source, ComplexMessage::protobufMetaObject));
+
+    ComplexMessage test;
+    test.deserialize(serializer.get(), direct);
+    EXPECT_TRUE(test == source);
+}
+
+TEST_F(DirectSerializationTest, NestedMessageSizesTest)
+{
+    NestedMessage shortNested;
+    shortNested.setTestFieldSInt32(-1);
+    shortNested.setTestFieldString("ab");
+
+    NestedMessage longNested;
+    longNested.setTestFieldString(QString(200, QChar('n')));
+
+    ComplexMessage first;
+    first.setTestFieldInt32(1);
+    first.setTestComplexField(longNested);
+
+    ComplexMessage second;
+    second.setTestComplexField(shortNested);
+    second.setTestFieldString("second");
+
+    OuterMessage source;
+    source.setTestFirstField(first);
+    source.setTestSecondField(second);
+    source.setTestFieldSInt32(-2);
+
+    //Sizes of sibling and nested messages are consumed in the order they were calculated
+    const QByteArray direct = source.serialize(serializer.get());
+    EXPECT_EQ(source.serializedSize(), direct.size());
+    EXPECT_TRUE(direct == serializer->serializeMessage(&source, OuterMessage::protobufMetaObject));
+
+    //Without size cache installed by serializer nested messages are still measured once
+    QByteArray uncached;
+    source.serializeTo(uncached);
+    EXPECT_TRUE(uncached == direct);
+
+    OuterMessage test;
+    test.deserialize(serializer.get(), direct);
+    EXPECT_TRUE(test == source);
+}
+
+TEST_F(DirectSerializationTest, UnknownFieldSkipTest)
+{
+    //Field 2 is varint 1 and unknown field 5 is length delimited "abc"
+    NestedMessage test;
+    test.deserialize(serializer.get(), QByteArray::fromHex("08022a03616263120178"));
+    EXPECT_EQ(test.testFieldSInt32(), 1);
+    EXPECT_STREQ(test.testFieldString().toStdString().c_str(), "x");
+
+    //Unknown field is preserved and appended after known fields
+    ASSERT_EQ(test.unknownFields().fields().size(), 1);
+    EXPECT_STREQ(test.serialize(serializer.get()).toHex().toStdString().c_str(), "08021201782a03616263");
+}
+
+TEST_F(DirectSerializationTest, WireTypeMismatchTest)
+{
+    //Field 1 is length delimited "a" and field 2 is varint 5, both don't match field types
+    NestedMessage test;
+    test.deserialize(serializer.get(), QByteArray::fromHex("0a01611005"));
+    EXPECT_EQ(test.testFieldSInt32(), 0);
+    EXPECT_TRUE(test.testFieldString().isEmpty());
+    ASSERT_EQ(test.unknownFields().fields().size(), 2);
+    EXPECT_STREQ(test.serialize(serializer.get()).toHex().toStdString().c_str(), "0a01611005");
+
+    //Nested message field 2 is varint 1
+    ComplexMessage complex;
+    complex.deserialize(serializer.get(), QByteArray::fromHex("08011001"));
+    EXPECT_EQ(complex.testFieldInt32(), 1);
+    EXPECT_TRUE(complex.testComplexField() == NestedMessage());
+    EXPECT_EQ(complex.unknownFields().fields().size(), 1);
+}
+
+TEST_F(DirectSerializationTest, UnpackedRepeatedFieldTest)
+{
+    //Unpacked and packed elements of field 1 are merged, fields 3 and 7 are unpacked
+    RepeatedMessage test;
+    test.deserialize(serializer.get(), QByteArray::fromHex("080108020a0203041d2a0000003802"));
+    EXPECT_TRUE(test.testRepeatedInt32() == int32List({1, 2, 3, 4}));
+    EXPECT_TRUE(test.testRepeatedFixed32() == fixed32List({42}));
+    ASSERT_EQ(test.testRepeatedEnum().size(), 1);
+    EXPECT_EQ(test.testRepeatedEnum().at(0), RepeatedMessage::LOCAL_ENUM_VALUE2);
+    EXPECT_TRUE(test.unknownFields().fields().isEmpty());
+
+    //Repeated fields are written packed
+    EXPECT_STREQ(test.serialize(serializer.get()).toHex().toStdString().c_str(), "0a04010203041a042a0000003a0102");
+}
+
+TEST_F(DirectSerializationTest, MalformedMessageTest)
+{
+    NestedMessage test;
+    EXPECT_THROW(test.deserialize(serializer.get(), QByteArray::fromHex("1205616263")), std::out_of_range);
+}
+
+TEST_F(DirectSerializationTest, InPlaceDeserializationTest)
+{
+    ComplexMessage test;
+    int intChangedCount = 0;
+    int stringChangedCount = 0;
+    QObject::connect(&test, &ComplexMessage::testFieldInt32Changed, [&intChangedCount] {
+        ++intChangedCount;
+    });
+    QObject::connect(&test, &ComplexMessage::testFieldStringChanged, [&stringChangedCount] {
+        ++stringChangedCount;
+    });
+
+    test.deserialize(serializer.get(), QByteArray::fromHex("0805120308f6011a0178"), QAbstractProtobufSerializer::InPlaceDeserialization);
+    EXPECT_EQ(test.testFieldInt32(), 5);
+    EXPECT_EQ(test.testComplexField().testFieldSInt32(), 123);
+    EXPECT_TRUE(test.testFieldString() == QString("x"));
+    //Generated parseFrom doesn't use setters, notify signals are emitted after message is parsed
+    EXPECT_EQ(intChangedCount, 1);
+    EXPECT_EQ(stringChangedCount, 1);
+
+    test.deserialize(serializer.get(), QByteArray::fromHex("1a0179"), QAbstractProtobufSerializer::InPlaceDeserialization);
+    EXPECT_EQ(test.testFieldInt32(), 0);
+    EXPECT_EQ(test.testComplexField().testFieldSInt32(), 0);
+    EXPECT_TRUE(test.testFieldString() == QString("y"));
+    //Reset of the int field is notified, but it's not changed by parsing
+    EXPECT_EQ(intChangedCount, 2);
+    //String field is changed by both reset and parsing
+    EXPECT_EQ(stringChangedCount, 3);
+
+    //Fields that are not present in data are only notified if reset changes them
+    test.deserialize(serializer.get(), QByteArray(), QAbstractProtobufSerializer::InPlaceDeserialization);
+    EXPECT_EQ(intChangedCount, 2);
+    EXPECT_EQ(stringChangedCount, 4);
+}
+
+TEST_F(DirectSerializationTest, PropertyBasedFallbackTest)
+{
+    //Map fields are not supported by generated serialization
+    MapMessage source;
+    source.setTestMap({{10, "ten"}, {-1, "minus one"}});
+
+    MapMessage test;
+    test.deserialize(serializer.get(), source.serialize(serializer.get()));
+    EXPECT_TRUE(test.testMap() == source.testMap());
+}
+
+TEST_F(DirectSerializationTest, DISABLED_DirectSerializationBenchmarkTest)
+{
+    //Same message is serialized and deserialized using meta properties and using generated methods
+    const int count = 100000;
+    ScalarMessage source = createScalarMessage();
+
+    QByteArray reflectiveData;
+    const qint64 reflectiveSerializeTime = measureNsecs(count, [&]() {
+        reflectiveData = serializer->serializeMessage(&source, ScalarMessage::protobufMetaObject);
+    });
+
+    QByteArray data;
+    const qint64 directSerializeTime = measureNsecs(count, [&]() {
+        data = source.serialize(serializer.get());
+    });
+    ASSERT_TRUE(data == reflectiveData);
+
+    ScalarMessage reflectiveTest;
+    const qint64 reflectiveDeserializeTime = measureNsecs(count, [&]() {
+        serializer->deserializeMessage(&reflectiveTest, ScalarMessage::protobufMetaObject, data);
+    });
+
+    ScalarMessage test;
+    const qint64 directDeserializeTime = measureNsecs(count, [&]() {
+        test.deserialize(serializer.get(), data);
+    });
+
+    ASSERT_TRUE(reflectiveTest == source);
+    ASSERT_TRUE(test == source);
+    reportTime("reflectiveSerializeTime", reflectiveSerializeTime);
+    reportTime("directSerializeTime", directSerializeTime);
+    reportTime("reflectiveDeserializeTime", reflectiveDeserializeTime);
+    reportTime("directDeserializeTime", directDeserializeTime);
+}
+}
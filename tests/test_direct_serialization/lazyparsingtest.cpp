@@ -0,0 +1,190 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+
+#include "directserialization.qpb.h"
+#include "../benchmarkcommon.h"
+
+#include <QProtobufSerializer>
+#include <QProtobufLazyString>
+
+#include <gtest/gtest.h>
+
+#include <memory>
+
+using namespace qtprotobufnamespace::direct::tests;
+
+namespace QtProtobuf {
+namespace tests {
+
+class LazyParsingTest : public ::testing::Test
+{
+public:
+    LazyParsingTest() = default;
+
+    void SetUp() override;
+    static void SetUpTestCase();
+
+protected:
+    std::unique_ptr<QProtobufSerializer> serializer;
+};
+
+void LazyParsingTest::SetUpTestCase()
+{
+    QtProtobuf::qRegisterProtobufTypes();
+}
+
+void LazyParsingTest::SetUp()
+{
+    serializer.reset(new QProtobufSerializer);
+}
+
+TEST_F(LazyParsingTest, UntouchedMessageTest)
+{
+    //Nested message fields are written in reverse order, that is kept while message is not accessed
+    const QByteArray data = QByteArray::fromHex("0805120712036162630802" "1a0178");
+    ComplexMessage test;
+    test.deserialize(serializer.get(), data);
+
+    EXPECT_EQ(test.testFieldInt32(), 5);
+    EXPECT_TRUE(test.testFieldString() == QString("x"));
+    EXPECT_TRUE(test.serialize(serializer.get()) == data);
+}
+
+TEST_F(LazyParsingTest, AccessedMessageTest)
+{
+    ComplexMessage test;
+    test.deserialize(serializer.get(), QByteArray::fromHex("0805120712036162630802" "1a0178"));
+
+    EXPECT_EQ(test.testComplexField().testFieldSInt32(), 1);
+    EXPECT_TRUE(test.testComplexField().testFieldString() == QString("abc"));
+    EXPECT_STREQ(test.serialize(serializer.get()).toHex().toStdString().c_str(), "0805120708021203616263" "1a0178");
+}
+
+TEST_F(LazyParsingTest, MergeMessageTest)
+{
+    ComplexMessage test;
+    test.deserialize(serializer.get(), QByteArray::fromHex("12020802" "12051203616263"));
+
+    EXPECT_STREQ(test.serialize(serializer.get()).toHex().toStdString().c_str(), "12070802" "1203616263");
+    EXPECT_EQ(test.testComplexField().testFieldSInt32(), 1);
+    EXPECT_TRUE(test.testComplexField().testFieldString() == QString("abc"));
+    EXPECT_EQ(test.testFieldInt32(), 0);
+}
+
+TEST_F(LazyParsingTest, CopyMessageTest)
+{
+    const QByteArray data = QByteArray::fromHex("0805120712036162630802");
+    ComplexMessage test;
+    test.deserialize(serializer.get(), data);
+
+    ComplexMessage copy(test);
+    EXPECT_TRUE(copy.serialize(serializer.get()) == data);
+
+    ComplexMessage assigned;
+    assigned.setTestFieldInt32(10);
+    assigned = test;
+    EXPECT_TRUE(assigned.serialize(serializer.get()) == data);
+
+    EXPECT_TRUE(copy == test);
+    EXPECT_EQ(copy.testComplexField().testFieldSInt32(), 1);
+}
+
+TEST_F(LazyParsingTest, MalformedNestedMessageTest)
+{
+    ComplexMessage test;
+    EXPECT_NO_THROW(test.deserialize(serializer.get(), QByteArray::fromHex("080512040802" "12ff")));
+    EXPECT_EQ(test.testFieldInt32(), 5);
+    EXPECT_EQ(test.testComplexField().testFieldSInt32(), 1);
+    EXPECT_TRUE(test.testComplexField().testFieldString().isEmpty());
+}
+
+TEST_F(LazyParsingTest, UntouchedStringTest)
+{
+    //Malformed UTF-8 data is kept as is, until string is changed
+    const QByteArray data = QByteArray::fromHex("0805" "1a03ff6162");
+    ComplexMessage test;
+    test.deserialize(serializer.get(), data);
+    EXPECT_TRUE(test.serialize(serializer.get()) == data);
+
+    EXPECT_TRUE(test.testFieldString() == QString::fromUtf8(QByteArray::fromHex("ff6162")));
+    EXPECT_TRUE(test.serialize(serializer.get()) == data);
+
+    ComplexMessage copy(test);
+    EXPECT_TRUE(copy.serialize(serializer.get()) == data);
+
+    test.setTestFieldString("abc");
+    EXPECT_STREQ(test.serialize(serializer.get()).toHex().toStdString().c_str(), "08051a03616263");
+}
+
+TEST_F(LazyParsingTest, LazyStringDecodeTest)
+{
+    const QByteArray asciiData("ASCII prefix");
+    const QByteArray mixedData = asciiData + QByteArray::fromHex("d0bfd180d0b8d0b2d0b5d182f09f9880");
+    EXPECT_TRUE(QProtobufLazyString::fromUtf8(asciiData).toString() == QString::fromLatin1(asciiData));
+    EXPECT_TRUE(QProtobufLazyString::fromUtf8(mixedData).toString() == QString::fromUtf8(mixedData));
+    EXPECT_TRUE(QProtobufLazyString::fromUtf8(QByteArray()).isEmpty());
+    EXPECT_TRUE(QProtobufLazyString::fromUtf8(mixedData) == QString::fromUtf8(mixedData));
+    EXPECT_TRUE(QProtobufLazyString::fromUtf8(mixedData) != QProtobufLazyString::fromUtf8(asciiData));
+}
+
+TEST_F(LazyParsingTest, DISABLED_NonAsciiStringDecodeBenchmarkTest)
+{
+    //Message with ~2KB long non-ASCII string field, that is parsed and then read
+    const int count = 100000;
+    QString text;
+    for (int i = 0; i < 64; ++i) {
+        text.append(QString::fromUtf8("Тестовая строка"));
+    }
+    ComplexMessage source;
+    source.setTestFieldInt32(42);
+    source.setTestFieldString(text);
+    const QByteArray data = source.serialize(serializer.get());
+    const QByteArray utf8 = text.toUtf8();
+
+    //String is not decoded while message is parsed
+    ComplexMessage test;
+    const qint64 parseTime = measureNsecs(count, [&]() {
+        test.deserialize(serializer.get(), data);
+    });
+
+    QString decoded;
+    const qint64 parseAndReadTime = measureNsecs(count, [&]() {
+        test.deserialize(serializer.get(), data);
+        decoded = test.testFieldString();
+    });
+    ASSERT_TRUE(decoded == text);
+
+    //QString::fromUtf8 is the decoder used by QProtobufLazyString
+    const qint64 decodeTime = measureNsecs(count, [&]() {
+        decoded = QString::fromUtf8(utf8);
+    });
+    ASSERT_TRUE(decoded == text);
+
+    reportTime("parseTime", parseTime);
+    reportTime("parseAndReadTime", parseAndReadTime);
+    reportTime("decodeTime", decodeTime);
+}
+
+}
+}
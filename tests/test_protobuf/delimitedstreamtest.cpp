@@ -0,0 +1,193 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Alexey Edelev <semlanik@gmail.com>
+ *
+ * This file is part of QtProtobuf project https://git.semlanik.org/semlanik/qtprotobuf
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and
+ * to permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+ * FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+
+#include "simpletest.qpb.h"
+
+#include <QBuffer>
+#include <QProtobufDelimitedWriter>
+#include <QProtobufDelimitedReader>
+#include <QProtobufRecordFile>
+#include <QTemporaryFile>
+
+#include <gtest/gtest.h>
+
+using namespace qtprotobufnamespace::tests;
+
+namespace QtProtobuf {
+namespace tests {
+
+class DelimitedStreamTest : public ::testing::Test
+{
+public:
+    DelimitedStreamTest() = default;
+    static void SetUpTestCase() {
+        QtProtobuf::qRegisterProtobufTypes();
+    }
+};
+
+TEST_F(DelimitedStreamTest, WriteTest)
+{
+    QByteArray data;
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::WriteOnly);
+    {
+        QProtobufDelimitedWriter writer(&buffer);
+        SimpleIntMessage message;
+        message.setTestFieldInt(15);
+        EXPECT_TRUE(writer.write(message));
+        message.setTestFieldInt(0);
+        EXPECT_TRUE(writer.write(message));
+        EXPECT_TRUE(writer.writeRecord(QByteArray::fromHex("0801")));
+        EXPECT_TRUE(data.isEmpty());
+    }
+    EXPECT_STREQ(data.toHex().toStdString().c_str(), "02080f" "00" "020801");
+
+    SimpleStringMessage longMessage;
+    longMessage.setTestFieldString(QString(200, 'a'));
+    data.clear();
+    buffer.seek(0);
+    QProtobufDelimitedWriter writer(&buffer, 16);
+    EXPECT_TRUE(writer.write(longMessage));
+    EXPECT_STREQ(data.left(4).toHex().toStdString().c_str(), "cb0132c8");
+    EXPECT_EQ(data.size(), 205);
+}
+
+TEST_F(DelimitedStreamTest, RoundTripTest)
+{
+    QByteArray data;
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::WriteOnly);
+    {
+        QProtobufDelimitedWriter writer(&buffer, 256);
+        for (int i = 0; i < 1000; i++) {
+            ComplexMessage message;
+            message.setTestFieldInt(i);
+            message.setTestComplexField(SimpleStringMessage({QString::number(i)}));
+            ASSERT_TRUE(writer.write(message));
+        }
+        SimpleStringMessage longMessage;
+        longMessage.setTestFieldString(QString(200, 'a'));
+        ASSERT_TRUE(writer.write(longMessage));
+    }
+    buffer.close();
+
+    buffer.open(QIODevice::ReadOnly);
+    QProtobufDelimitedReader reader(&buffer, 64);
+    QList<QSharedPointer<ComplexMessage>> messages;
+    while (messages.size() < 1000) {
+        ASSERT_EQ(reader.readBatch(messages, std::min(qsizetype(100), 1000 - messages.size())), 100);
+    }
+    for (int i = 0; i < 1000; i++) {
+        ASSERT_EQ(messages.at(i)->testFieldInt(), i);
+        ASSERT_TRUE(messages.at(i)->testComplexField().testFieldString() == QString::number(i));
+    }
+
+    SimpleStringMessage longMessage;
+    ASSERT_TRUE(reader.read(&longMessage));
+    EXPECT_TRUE(longMessage.testFieldString() == QString(200, 'a'));
+
+    EXPECT_TRUE(reader.atEnd());
+    EXPECT_FALSE(reader.read(&longMessage));
+    EXPECT_EQ(reader.readBatch(messages, 10), 0);
+}
+
+TEST_F(DelimitedStreamTest, TruncatedDataTest)
+{
+    QByteArray data = QByteArray::fromHex("02080f05080f");
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::ReadOnly);
+    QProtobufDelimitedReader reader(&buffer);
+    SimpleIntMessage message;
+    ASSERT_TRUE(reader.read(&message));
+    EXPECT_EQ(message.testFieldInt(), 15);
+    EXPECT_THROW(reader.read(&message), std::out_of_range);
+
+    QByteArray sizeData = QByteArray::fromHex("ff");
+    QBuffer sizeBuffer(&sizeData);
+    sizeBuffer.open(QIODevice::ReadOnly);
+    QProtobufDelimitedReader sizeReader(&sizeBuffer);
+    EXPECT_THROW(sizeReader.read(&message), std::out_of_range);
+}
+
+TEST_F(DelimitedStreamTest, RecordFileTest)
+{
+    QTemporaryFile tempFile;
+    ASSERT_TRUE(tempFile.open());
+    {
+        QProtobufDelimitedWriter writer(&tempFile);
+        for (int i = 0; i < 1000; i++) {
+            ComplexMessage message;
+            message.setTestFieldInt(i);
+            message.setTestComplexField(SimpleStringMessage({QString::number(i)}));
+            ASSERT_TRUE(writer.write(message));
+        }
+    }
+    tempFile.close();
+
+    QProtobufRecordFile file(tempFile.fileName());
+    ASSERT_TRUE(file.open());
+
+    int count = 0;
+    qsizetype previousOffset = -1;
+    for (auto it = file.begin(); it != file.end(); ++it) {
+        EXPECT_LT(previousOffset, it.offset());
+        previousOffset = it.offset();
+        ++count;
+    }
+    EXPECT_EQ(count, 1000);
+
+    file.buildIndex();
+    ASSERT_EQ(file.recordCount(), 1000);
+
+    ComplexMessage message;
+    file.read(500, &message);
+    EXPECT_EQ(message.testFieldInt(), 500);
+    EXPECT_TRUE(message.testComplexField().testFieldString() == QString("500"));
+
+    file.read(999, &message);
+    EXPECT_EQ(message.testFieldInt(), 999);
+
+    ComplexMessage first;
+    file.readAt(0, &first);
+    EXPECT_EQ(first.testFieldInt(), 0);
+    EXPECT_TRUE(first.testComplexField().testFieldString() == QString("0"));
+
+    EXPECT_THROW(file.record(1000), std::out_of_range);
+}
+
+TEST_F(DelimitedStreamTest, TruncatedRecordFileTest)
+{
+    QTemporaryFile tempFile;
+    ASSERT_TRUE(tempFile.open());
+    tempFile.write(QByteArray::fromHex("02080f05080f"));
+    tempFile.close();
+
+    QProtobufRecordFile file(tempFile.fileName());
+    ASSERT_TRUE(file.open());
+    EXPECT_EQ(file.recordAt(0).toHex(), QByteArray("080f"));
+    EXPECT_THROW(file.buildIndex(), std::out_of_range);
+}
+
+}
+}
@@ -24,9 +24,14 @@
  */
 
 #include "deserializationtest.h"
+#include "../benchmarkcommon.h"
 
 #include "simpletest.qpb.h"
 
+#include <QProtobufStreamParser>
+
+#include <limits>
+
 using namespace qtprotobufnamespace::tests;
 using namespace QtProtobuf::tests;
 using namespace QtProtobuf;
@@ -415,6 +420,37 @@ TEST_F(DeserializationTest, RepeatedBytesMessageTest)
                                                              QByteArray::fromHex("010203040506")}));
 }
 
+TEST_F(DeserializationTest, NestedBytesSharedDataTest)
+{
+    SimpleBytesMessage bytesMsg;
+    bytesMsg.setTestFieldBytes(QByteArray(1024, 'x'));
+    RepeatedComplexMessage source;
+    QSharedPointer<ComplexMessage> complexMsg(new ComplexMessage);
+    complexMsg->setTestFieldInt(1);
+    SimpleStringMessage stringMsg;
+    stringMsg.setTestFieldString("qwerty");
+    complexMsg->setTestComplexField(stringMsg);
+    source.setTestRepeatedComplex({complexMsg, complexMsg});
+
+    RepeatedComplexMessage nested;
+    nested.deserialize(serializer.get(), source.serialize(serializer.get()));
+    ASSERT_EQ(2, nested.testRepeatedComplex().count());
+    ASSERT_TRUE(*nested.testRepeatedComplex().at(1) == *complexMsg);
+
+    QByteArray data = bytesMsg.serialize(serializer.get());
+    SimpleBytesMessage test;
+    test.deserialize(serializer.get(), data);
+    ASSERT_TRUE(test.testFieldBytes() == QByteArray(1024, 'x'));
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+    //Bytes field data is shared with input buffer
+    ASSERT_TRUE(test.testFieldBytes().constData() >= data.constData()
+                && test.testFieldBytes().constData() < data.constData() + data.size());
+#endif
+    //Field data stays valid when input buffer is released
+    data = QByteArray();
+    ASSERT_TRUE(test.testFieldBytes() == QByteArray(1024, 'x'));
+}
+
 TEST_F(DeserializationTest, RepeatedFloatMessageTest)
 {
     RepeatedFloatMessage test;
@@ -423,6 +459,15 @@ TEST_F(DeserializationTest, RepeatedFloatMessageTest)
     ASSERT_TRUE(test.testRepeatedFloat() == FloatList({0.4f, 1.2f, 0.5f, 1.4f, 0.6f}));
 }
 
+TEST_F(DeserializationTest, RepeatedFloatMalformedMessageTest)
+{
+    RepeatedFloatMessage test;
+    //Packed payload size is not multiple of float size
+    EXPECT_THROW(test.deserialize(serializer.get(), QByteArray::fromHex("0a06cdcccc3e9a99")), std::invalid_argument);
+    //Packed payload is longer than remaining data
+    EXPECT_THROW(test.deserialize(serializer.get(), QByteArray::fromHex("0a08cdcccc3e")), std::out_of_range);
+}
+
 TEST_F(DeserializationTest, RepeatedDoubleMessageTest)
 {
     RepeatedDoubleMessage test;
@@ -886,6 +931,46 @@ TEST_F(DeserializationTest, FieldIndexRangeTest)
     ASSERT_EQ(msg4.testField(), 1);
 }
 
+TEST_F(DeserializationTest, UnknownFieldsPreserveTest)
+{
+    //Field 2 is length delimited "abc" and field 3 is varint 5, both are unknown for SimpleIntMessage
+    const QByteArray data = QByteArray::fromHex("080f12036162631805");
+    SimpleIntMessage msg;
+    msg.deserialize(serializer.get(), data);
+    EXPECT_EQ(msg.testFieldInt(), 15);
+    ASSERT_EQ(msg.unknownFields().fields().size(), 2);
+    EXPECT_STREQ(msg.unknownFields().fields().at(0).toHex().toStdString().c_str(), "1203616263");
+    EXPECT_STREQ(msg.unknownFields().fields().at(1).toHex().toStdString().c_str(), "1805");
+    EXPECT_EQ(msg.unknownFields().size(), 7);
+
+    EXPECT_TRUE(msg.serialize(serializer.get()) == data);
+
+    SimpleIntMessage copy(msg);
+    EXPECT_TRUE(copy.serialize(serializer.get()) == data);
+    SimpleIntMessage moved(std::move(copy));
+    EXPECT_TRUE(moved.serialize(serializer.get()) == data);
+
+    //Unknown fields of nested message are preserved too
+    const QByteArray complexData = QByteArray::fromHex("082a120a32067177657274792003");
+    ComplexMessage complexMsg;
+    complexMsg.deserialize(serializer.get(), complexData);
+    EXPECT_EQ(complexMsg.testFieldInt(), 42);
+    EXPECT_STREQ(complexMsg.testComplexField().testFieldString().toStdString().c_str(), "qwerty");
+    EXPECT_EQ(complexMsg.testComplexField().unknownFields().fields().size(), 1);
+    EXPECT_TRUE(complexMsg.serialize(serializer.get()) == complexData);
+}
+
+TEST_F(DeserializationTest, SparseFieldIndexTest)
+{
+    //Field 999 is unknown and skipped
+    SparseFieldIndexMessage msg;
+    msg.deserialize(serializer.get(), QByteArray::fromHex("0802c03e01a21f026162f8ffffff0f04b83e05"));
+    EXPECT_EQ(msg.testFieldDense(), 1);
+    EXPECT_EQ(msg.testFieldSparse(), -1);
+    EXPECT_EQ(msg.testFieldMax(), 2);
+    EXPECT_STREQ(msg.testFieldString().toStdString().c_str(), "ab");
+}
+
 TEST_F(DeserializationTest, SimpleEnumListMessageTest)
 {
     SimpleEnumListMessage msg;
@@ -901,3 +986,450 @@ TEST_F(DeserializationTest, SimpleEnumListMessageTest)
                 SimpleEnumListMessage::LOCAL_ENUM_VALUE2,
                 SimpleEnumListMessage::LOCAL_ENUM_VALUE3}));
 }
+
+TEST_F(DeserializationTest, VarintBoundsTest)
+{
+    SimpleUInt64Message test;
+    test.deserialize(serializer.get(), QByteArray::fromHex("08ffffffffffffffffff01"));
+    ASSERT_EQ(test.testFieldInt(), std::numeric_limits<uint64_t>::max());
+
+    //Truncated varint at the end of buffer
+    EXPECT_THROW(test.deserialize(serializer.get(), QByteArray::fromHex("08ffff")), std::out_of_range);
+    //Varint is longer than 10 bytes
+    EXPECT_THROW(test.deserialize(serializer.get(), QByteArray::fromHex("08ffffffffffffffffffff01")), std::invalid_argument);
+    //Truncated fixed-size field
+    SimpleFixedInt64Message fixedTest;
+    EXPECT_THROW(fixedTest.deserialize(serializer.get(), QByteArray::fromHex("090f0000")), std::out_of_range);
+}
+
+TEST_F(DeserializationTest, PackedVarintListTest)
+{
+    //Mix of single-byte and multi-byte values, long enough to cover both vectorized and scalar decoding
+    sint32List sintValues;
+    int32List intValues;
+    uint64List uint64Values;
+    for (int i = 0; i < 200; ++i) {
+        const int32_t value = (i % 7 == 0) ? -i * 100003 : (i % 3 == 0 ? i * 1000 : i % 50);
+        sintValues.append(value);
+        intValues.append(value);
+        uint64Values.append(i % 5 == 0 ? std::numeric_limits<uint64_t>::max() - i : static_cast<uint64_t>(i % 64));
+    }
+
+    RepeatedSIntMessage sintTest;
+    sintTest.setTestRepeatedInt(sintValues);
+    RepeatedSIntMessage sintResult;
+    sintResult.deserialize(serializer.get(), sintTest.serialize(serializer.get()));
+    ASSERT_TRUE(sintResult.testRepeatedInt() == sintValues);
+
+    RepeatedIntMessage intTest;
+    intTest.setTestRepeatedInt(intValues);
+    RepeatedIntMessage intResult;
+    intResult.deserialize(serializer.get(), intTest.serialize(serializer.get()));
+    ASSERT_TRUE(intResult.testRepeatedInt() == intValues);
+
+    RepeatedUInt64Message uint64Test;
+    uint64Test.setTestRepeatedInt(uint64Values);
+    RepeatedUInt64Message uint64Result;
+    uint64Result.deserialize(serializer.get(), uint64Test.serialize(serializer.get()));
+    ASSERT_TRUE(uint64Result.testRepeatedInt() == uint64Values);
+
+    //Last varint in packed field is truncated
+    EXPECT_THROW(sintResult.deserialize(serializer.get(), QByteArray::fromHex("0a030102ff")), std::out_of_range);
+}
+
+TEST_F(DeserializationTest, DISABLED_VarintBenchmarkTest)
+{
+    //Varint-heavy packed payload: 100000 9-bytes long uint64 values
+    const int count = 100000;
+    QByteArray payload;
+    for (int i = 0; i < count; ++i) {
+        payload.append(QByteArray::fromHex("ffffffffffffffff7f"));
+    }
+    const QByteArray data = QByteArray::fromHex("0aa0f736") + payload;
+
+    uint64List referenceValues;
+    const qint64 referenceTime = measureNsecs(10, [&]() {
+        referenceValues = referenceDecodeVarints<uint64>(data, 4);
+    });
+
+    RepeatedUInt64Message test;
+    const qint64 messageTime = measureNsecs(10, [&]() {
+        test.deserialize(serializer.get(), data);
+    });
+
+    ASSERT_EQ(test.testRepeatedInt().count(), count);
+    ASSERT_TRUE(test.testRepeatedInt() == referenceValues);
+    reportTime("referenceTime", referenceTime);
+    reportTime("messageTime", messageTime);
+}
+
+TEST_F(DeserializationTest, DISABLED_PackedFloatBenchmarkTest)
+{
+    //Sensor frame like payload: 100000 floats
+    const int count = 100000;
+    FloatList values;
+    values.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        values.append(i * 0.5f);
+    }
+
+    RepeatedFloatMessage source;
+    source.setTestRepeatedFloat(values);
+
+    QByteArray referenceData;
+    const qint64 referenceSerializeTime = measureNsecs(10, [&]() {
+        referenceData = QByteArray::fromHex("0a80b518") + referenceEncodeFixed(values);
+    });
+
+    QByteArray data;
+    const qint64 serializeTime = measureNsecs(10, [&]() {
+        data = source.serialize(serializer.get());
+    });
+    ASSERT_TRUE(data == referenceData);
+
+    FloatList referenceValues;
+    const qint64 referenceDeserializeTime = measureNsecs(10, [&]() {
+        referenceValues = referenceDecodeFixed<float>(data, 4);
+    });
+
+    RepeatedFloatMessage test;
+    const qint64 deserializeTime = measureNsecs(10, [&]() {
+        test.deserialize(serializer.get(), data);
+    });
+
+    ASSERT_TRUE(test.testRepeatedFloat() == values);
+    ASSERT_TRUE(referenceValues == values);
+    reportTime("referenceSerializeTime", referenceSerializeTime);
+    reportTime("serializeTime", serializeTime);
+    reportTime("referenceDeserializeTime", referenceDeserializeTime);
+    reportTime("deserializeTime", deserializeTime);
+}
+
+TEST_F(DeserializationTest, DISABLED_RepeatedFieldScalingBenchmarkTest)
+{
+    //Deserialization time of repeated fields should grow linearly with number of elements
+    auto measure = [this](int count) -> qint64 {
+        QStringList strings;
+        ComplexMessageRepeated complexList;
+        SimpleSInt32StringMapMessage::MapFieldEntry map;
+        for (int i = 0; i < count; ++i) {
+            strings.append(QString::number(i));
+            QSharedPointer<ComplexMessage> msg(new ComplexMessage);
+            msg->setTestFieldInt(i);
+            complexList.append(msg);
+            map.insert(i, QString::number(i));
+        }
+
+        RepeatedStringMessage stringSource;
+        stringSource.setTestRepeatedString(strings);
+        RepeatedComplexMessage complexSource;
+        complexSource.setTestRepeatedComplex(complexList);
+        SimpleSInt32StringMapMessage mapSource;
+        mapSource.setMapField(map);
+        const QByteArray stringData = stringSource.serialize(serializer.get());
+        const QByteArray complexData = complexSource.serialize(serializer.get());
+        const QByteArray mapData = mapSource.serialize(serializer.get());
+
+        RepeatedStringMessage stringTest;
+        RepeatedComplexMessage complexTest;
+        SimpleSInt32StringMapMessage mapTest;
+        const qint64 elapsed = measureNsecs(1, [&]() {
+            stringTest.deserialize(serializer.get(), stringData);
+            complexTest.deserialize(serializer.get(), complexData);
+            mapTest.deserialize(serializer.get(), mapData);
+        });
+
+        EXPECT_EQ(stringTest.testRepeatedString().count(), count);
+        EXPECT_EQ(complexTest.testRepeatedComplex().count(), count);
+        EXPECT_EQ(mapTest.mapField().count(), count);
+        return elapsed;
+    };
+
+    //Quadratic decoding takes ~4 times longer for twice as many elements, linear one ~2 times
+    reportTime("halfTime", measure(25000));
+    reportTime("fullTime", measure(50000));
+}
+
+TEST_F(DeserializationTest, StreamParserTest)
+{
+    const QByteArray data = QByteArray::fromHex("0a0c0819120832067177657274790a0c0819120832067177657274790a0c081912083206717765727479");
+    for (int chunkSize : {1, 3, 14, 100}) {
+        RepeatedComplexMessage test;
+        QProtobufStreamParser parser(&test);
+        for (int i = 0; i < data.size(); i += chunkSize) {
+            parser.feed(data.mid(i, chunkSize));
+            EXPECT_LT(parser.pendingBytes(), 14 + chunkSize);
+        }
+        parser.finish();
+        ASSERT_EQ(3, test.testRepeatedComplex().count());
+        ASSERT_EQ(25, test.testRepeatedComplex().at(2)->testFieldInt());
+        ASSERT_TRUE(test.testRepeatedComplex().at(2)->testComplexField().testFieldString() == QString("qwerty"));
+    }
+
+    SimpleSInt32StringMapMessage mapTest;
+    QProtobufStreamParser mapParser(&mapTest);
+    const QByteArray mapData = QByteArray::fromHex("0a14085312106d696e757320666f757274792074776f0a070814120374656e0a0b081e12076669667465656e");
+    mapParser.feed(mapData.left(5));
+    mapParser.feed(mapData.mid(5));
+    EXPECT_EQ(mapParser.pendingBytes(), 0);
+    mapParser.finish();
+    ASSERT_TRUE(mapTest.mapField() == SimpleSInt32StringMapMessage::MapFieldEntry({{10, {"ten"}}, {-42, {"minus fourty two"}}, {15, {"fifteen"}}}));
+}
+
+TEST_F(DeserializationTest, StreamParserIncompleteDataTest)
+{
+    RepeatedComplexMessage test;
+    QProtobufStreamParser parser(&test);
+    parser.feed(QByteArray::fromHex("0a0c0819120832067177657274790a0c08191208"));
+    EXPECT_EQ(parser.pendingBytes(), 6);
+    EXPECT_THROW(parser.finish(), std::out_of_range);
+    //Complete fields are kept
+    ASSERT_EQ(1, test.testRepeatedComplex().count());
+
+    SimpleIntMessage invalid;
+    QProtobufStreamParser invalidParser(&invalid);
+    EXPECT_THROW(invalidParser.feed(QByteArray::fromHex("0f01")), std::invalid_argument);
+}
+
+TEST_F(DeserializationTest, StreamParserNestedFieldsTest)
+{
+    ComplexMessage source;
+    source.setTestFieldInt(42);
+    source.setTestComplexField(SimpleStringMessage({QString(100000, QChar('q'))}));
+    const QByteArray data = source.serialize(serializer.get());
+
+    ComplexMessage test;
+    QProtobufStreamParser parser(&test);
+    for (int i = 0; i < data.size(); ++i) {
+        parser.feed(data.mid(i, 1));
+        //Only incomplete field header is buffered, when nested message is received by parts
+        ASSERT_LT(parser.pendingBytes(), 4);
+    }
+    parser.finish();
+    EXPECT_EQ(42, test.testFieldInt());
+    EXPECT_TRUE(test.testComplexField().testFieldString() == source.testComplexField().testFieldString());
+
+    SimpleBytesMessage bytesSource;
+    bytesSource.setTestFieldBytes(QByteArray(65536, 'b'));
+    const QByteArray bytesData = bytesSource.serialize(serializer.get());
+
+    SimpleBytesMessage bytesTest;
+    QProtobufStreamParser bytesParser(&bytesTest);
+    for (int i = 0; i < bytesData.size(); i += 7) {
+        bytesParser.feed(bytesData.mid(i, 7));
+        ASSERT_LT(bytesParser.pendingBytes(), 4);
+    }
+    bytesParser.finish();
+    EXPECT_TRUE(bytesTest.testFieldBytes() == bytesSource.testFieldBytes());
+}
+
+TEST_F(DeserializationTest, StreamParserPackedFieldsTest)
+{
+    RepeatedSInt64Message source;
+    sint64List values;
+    for (int i = 0; i < 10000; ++i) {
+        values.append(i % 2 == 0 ? std::numeric_limits<qint64>::min() + i : i);
+    }
+    source.setTestRepeatedInt(values);
+    const QByteArray data = source.serialize(serializer.get());
+
+    RepeatedSInt64Message test;
+    QProtobufStreamParser parser(&test);
+    for (int i = 0; i < data.size(); i += 3) {
+        parser.feed(data.mid(i, 3));
+        //Only incomplete element of packed list is buffered
+        ASSERT_LT(parser.pendingBytes(), 10);
+    }
+    parser.finish();
+    EXPECT_TRUE(test.testRepeatedInt() == values);
+
+    RepeatedFloatMessage floatSource;
+    FloatList floatValues;
+    for (int i = 0; i < 10000; ++i) {
+        floatValues.append(i * 0.5f);
+    }
+    floatSource.setTestRepeatedFloat(floatValues);
+    const QByteArray floatData = floatSource.serialize(serializer.get());
+
+    RepeatedFloatMessage floatTest;
+    QProtobufStreamParser floatParser(&floatTest);
+    for (int i = 0; i < floatData.size(); i += 3) {
+        floatParser.feed(floatData.mid(i, 3));
+        ASSERT_LT(floatParser.pendingBytes(), 4);
+    }
+    floatParser.finish();
+    EXPECT_TRUE(floatTest.testRepeatedFloat() == floatValues);
+}
+
+TEST_F(DeserializationTest, StreamParserIncompleteNestedFieldTest)
+{
+    ComplexMessage source;
+    source.setTestFieldInt(42);
+    source.setTestComplexField(SimpleStringMessage({QString(1000, QChar('q'))}));
+    const QByteArray data = source.serialize(serializer.get());
+
+    ComplexMessage test;
+    QProtobufStreamParser parser(&test);
+    parser.feed(data.left(data.size() - 1));
+    EXPECT_EQ(parser.pendingBytes(), 0);
+    EXPECT_THROW(parser.finish(), std::out_of_range);
+    EXPECT_EQ(42, test.testFieldInt());
+}
+
+TEST_F(DeserializationTest, InPlaceDeserializationTest)
+{
+    ComplexMessage test;
+    int intChangedCount = 0;
+    int complexChangedCount = 0;
+    QObject::connect(&test, &ComplexMessage::testFieldIntChanged, [&intChangedCount] {
+        ++intChangedCount;
+    });
+    QObject::connect(&test, &ComplexMessage::testComplexFieldChanged, [&complexChangedCount] {
+        ++complexChangedCount;
+    });
+
+    test.deserialize(serializer.get(), QByteArray::fromHex("081912083206717765727479"), QAbstractProtobufSerializer::InPlaceDeserialization);
+    EXPECT_EQ(test.testFieldInt(), 25);
+    EXPECT_TRUE(test.testComplexField().testFieldString() == QString("qwerty"));
+    EXPECT_EQ(intChangedCount, 1);
+    //Nested message is replaced by deserialized one
+    EXPECT_EQ(complexChangedCount, 1);
+
+    const SimpleStringMessage *nested = &test.testComplexField();
+    test.deserialize(serializer.get(), QByteArray::fromHex("0819"), QAbstractProtobufSerializer::InPlaceDeserialization);
+    EXPECT_EQ(test.testFieldInt(), 25);
+    //Fields missing in data are reset, but nested message object is kept
+    EXPECT_TRUE(test.testComplexField().testFieldString().isEmpty());
+    EXPECT_EQ(&test.testComplexField(), nested);
+    EXPECT_EQ(complexChangedCount, 2);
+    //Value is reset to default and deserialized again
+    EXPECT_EQ(intChangedCount, 3);
+
+    EXPECT_THROW(test.deserialize(serializer.get(), QByteArray::fromHex("081a120561"), QAbstractProtobufSerializer::InPlaceDeserialization), std::out_of_range);
+    EXPECT_EQ(test.testFieldInt(), 26);
+}
+
+TEST_F(DeserializationTest, BatchedNotificationsTest)
+{
+    ComplexMessage test;
+    int intChangedCount = 0;
+    int complexChangedCount = 0;
+    QString nestedValueOnNotify;
+    QObject::connect(&test, &ComplexMessage::testFieldIntChanged, [&] {
+        ++intChangedCount;
+        //Whole message is already deserialized when first signal is emitted
+        nestedValueOnNotify = test.testComplexField().testFieldString();
+    });
+    QObject::connect(&test, &ComplexMessage::testComplexFieldChanged, [&complexChangedCount] {
+        ++complexChangedCount;
+    });
+
+    test.deserialize(serializer.get(), QByteArray::fromHex("081912083206717765727479"), QAbstractProtobufSerializer::CopyDeserialization, QAbstractProtobufSerializer::BatchedNotifications);
+    EXPECT_EQ(test.testFieldInt(), 25);
+    EXPECT_TRUE(nestedValueOnNotify == QString("qwerty"));
+    EXPECT_EQ(intChangedCount, 1);
+    EXPECT_EQ(complexChangedCount, 1);
+
+    //Same values don't cause notifications
+    test.deserialize(serializer.get(), QByteArray::fromHex("081912083206717765727479"), QAbstractProtobufSerializer::CopyDeserialization, QAbstractProtobufSerializer::BatchedNotifications);
+    EXPECT_EQ(intChangedCount, 1);
+    EXPECT_EQ(complexChangedCount, 1);
+
+    //Value that is reset and deserialized again is notified once. Nested message is replaced by
+    //deserialized one, so message field is notified too
+    test.deserialize(serializer.get(), QByteArray::fromHex("081a12083206717765727479"), QAbstractProtobufSerializer::InPlaceDeserialization, QAbstractProtobufSerializer::BatchedNotifications);
+    EXPECT_EQ(test.testFieldInt(), 26);
+    EXPECT_EQ(intChangedCount, 2);
+    EXPECT_EQ(complexChangedCount, 2);
+
+    //Value that is not changed by reset and deserialization is not notified
+    test.deserialize(serializer.get(), QByteArray::fromHex("081a12083206617364666768"), QAbstractProtobufSerializer::InPlaceDeserialization, QAbstractProtobufSerializer::BatchedNotifications);
+    EXPECT_TRUE(test.testComplexField().testFieldString() == QString("asdfgh"));
+    EXPECT_EQ(intChangedCount, 2);
+    EXPECT_EQ(complexChangedCount, 3);
+    EXPECT_FALSE(test.signalsBlocked());
+    EXPECT_FALSE(test.testComplexField().signalsBlocked());
+
+    //Batching is applied only to the call it was requested for
+    test.deserialize(serializer.get(), QByteArray::fromHex("081b12083206617364666768"), QAbstractProtobufSerializer::InPlaceDeserialization);
+    EXPECT_EQ(test.testFieldInt(), 27);
+    EXPECT_EQ(intChangedCount, 4);
+}
+
+TEST_F(DeserializationTest, TryDeserializeTest)
+{
+    ComplexMessage test;
+    QProtobufDecodeResult result = test.tryDeserialize(serializer.get(), QByteArray::fromHex("081912083206717765727479"));
+    EXPECT_TRUE(result.ok());
+    EXPECT_EQ(result.offset, -1);
+    EXPECT_EQ(test.testFieldInt(), 25);
+    EXPECT_TRUE(test.testComplexField().testFieldString() == QString("qwerty"));
+
+    //Object is not changed if data is malformed
+    result = test.tryDeserialize(serializer.get(), QByteArray::fromHex("081a12083206717765"));
+    EXPECT_EQ(result.status, QProtobufDecodeResult::TruncatedData);
+    EXPECT_EQ(result.offset, 2);
+    EXPECT_EQ(test.testFieldInt(), 25);
+    EXPECT_TRUE(test.testComplexField().testFieldString() == QString("qwerty"));
+
+    result = test.tryDeserialize(serializer.get(), QByteArray::fromHex("08191206320671776572"));
+    EXPECT_EQ(result.status, QProtobufDecodeResult::TruncatedData);
+    EXPECT_EQ(result.offset, 4);
+
+    result = test.tryDeserialize(serializer.get(), QByteArray::fromHex("081980"));
+    EXPECT_EQ(result.status, QProtobufDecodeResult::TruncatedData);
+    EXPECT_EQ(result.offset, 2);
+
+    result = test.tryDeserialize(serializer.get(), QByteArray::fromHex("08ffffffffffffffffffff01"));
+    EXPECT_EQ(result.status, QProtobufDecodeResult::MalformedVarint);
+    EXPECT_EQ(result.offset, 0);
+
+    result = test.tryDeserialize(serializer.get(), QByteArray::fromHex("08190019"));
+    EXPECT_EQ(result.status, QProtobufDecodeResult::InvalidFieldNumber);
+    EXPECT_EQ(result.offset, 2);
+
+    result = test.tryDeserialize(serializer.get(), QByteArray::fromHex("0f"));
+    EXPECT_EQ(result.status, QProtobufDecodeResult::InvalidWireType);
+    EXPECT_EQ(result.offset, 0);
+
+    result = test.tryDeserialize(serializer.get(), QByteArray::fromHex("0d19000000"));
+    EXPECT_EQ(result.status, QProtobufDecodeResult::WireTypeMismatch);
+    EXPECT_EQ(result.offset, 0);
+    EXPECT_EQ(test.testFieldInt(), 25);
+
+    //Unknown fields are checked only for structure
+    result = test.tryDeserialize(serializer.get(), QByteArray::fromHex("0819a50600000000"));
+    EXPECT_TRUE(result.ok());
+    EXPECT_EQ(test.testFieldInt(), 25);
+    EXPECT_TRUE(test.testComplexField().testFieldString().isEmpty());
+
+    result = test.tryDeserialize(serializer.get(), QByteArray::fromHex("081a"), QAbstractProtobufSerializer::InPlaceDeserialization);
+    EXPECT_TRUE(result.ok());
+    EXPECT_EQ(test.testFieldInt(), 26);
+
+    //In place deserialization keeps fields that were deserialized before the failure
+    result = test.tryDeserialize(serializer.get(), QByteArray::fromHex("081b12083206717765"), QAbstractProtobufSerializer::InPlaceDeserialization);
+    EXPECT_EQ(result.status, QProtobufDecodeResult::TruncatedData);
+    EXPECT_EQ(result.offset, 2);
+    EXPECT_EQ(test.testFieldInt(), 27);
+}
+
+TEST_F(DeserializationTest, TryDeserializePackedAndMapTest)
+{
+    RepeatedIntMessage repeated;
+    QProtobufDecodeResult result = repeated.tryDeserialize(serializer.get(), QByteArray::fromHex("0a03010283"));
+    EXPECT_EQ(result.status, QProtobufDecodeResult::InvalidPackedField);
+    EXPECT_EQ(result.offset, 0);
+    EXPECT_TRUE(repeated.testRepeatedInt().isEmpty());
+
+    result = repeated.tryDeserialize(serializer.get(), QByteArray::fromHex("0a03010203"));
+    EXPECT_TRUE(result.ok());
+    EXPECT_TRUE((repeated.testRepeatedInt() == int32List{1, 2, 3}));
+
+    //Map values are checked as nested messages
+    SimpleSInt32ComplexMessageMapMessage map;
+    result = map.tryDeserialize(serializer.get(), QByteArray::fromHex("0a09080212050d01000000"));
+    EXPECT_EQ(result.status, QProtobufDecodeResult::WireTypeMismatch);
+    EXPECT_EQ(result.offset, 6);
+    EXPECT_TRUE(map.mapField().isEmpty());
+}
@@ -24,9 +24,16 @@
  */
 
 #include "serializationtest.h"
+#include "../benchmarkcommon.h"
 
 #include "simpletest.qpb.h"
 
+#include <QBuffer>
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
 using namespace qtprotobufnamespace::tests;
 using namespace QtProtobuf::tests;
 using namespace QtProtobuf;
@@ -549,8 +556,7 @@ TEST_F(SerializationTest, FixedInt32MessageSerializeTest)
 
     test.setTestFieldFixedInt32(0);
     result = test.serialize(serializer.get());
-    ASSERT_EQ(result.size(), Fixed32MessageSize);
-    ASSERT_TRUE(result == QByteArray::fromHex("0d00000000"));
+    ASSERT_TRUE(result.isEmpty());
 
     test.setTestFieldFixedInt32(UINT8_MAX + 1);
     result = test.serialize(serializer.get());
@@ -599,8 +605,7 @@ TEST_F(SerializationTest, FixedInt64MessageSerializeTest)
 
     test.setTestFieldFixedInt64(0);
     result = test.serialize(serializer.get());
-    ASSERT_EQ(result.size(), Fixed64MessageSize);
-    ASSERT_TRUE(result == QByteArray::fromHex("090000000000000000"));
+    ASSERT_TRUE(result.isEmpty());
 
     test.setTestFieldFixedInt64(UINT8_MAX + 1);
     result = test.serialize(serializer.get());
@@ -659,8 +664,7 @@ TEST_F(SerializationTest, SFixedInt32MessageSerializeTest)
 
     test.setTestFieldFixedInt32(0);
     result = test.serialize(serializer.get());
-    ASSERT_EQ(result.size(), Fixed32MessageSize);
-    ASSERT_TRUE(result == QByteArray::fromHex("0d00000000"));
+    ASSERT_TRUE(result.isEmpty());
 
     test.setTestFieldFixedInt32(INT8_MAX + 1);
     result = test.serialize(serializer.get());
@@ -729,8 +733,7 @@ TEST_F(SerializationTest, SFixedInt64MessageSerializeTest)
 
     test.setTestFieldFixedInt64(0);
     result = test.serialize(serializer.get());
-    ASSERT_EQ(result.size(), Fixed64MessageSize);
-    ASSERT_TRUE(result == QByteArray::fromHex("090000000000000000"));
+    ASSERT_TRUE(result.isEmpty());
 
     test.setTestFieldFixedInt64(INT8_MAX + 1);
     result = test.serialize(serializer.get());
@@ -861,8 +864,7 @@ TEST_F(SerializationTest, DoubleMessageSerializeTest)
 
     test.setTestFieldDouble(0.0);
     result = test.serialize(serializer.get());
-    ASSERT_EQ(result.size(), DoubleMessageSize);
-    ASSERT_STREQ(result.toHex().toStdString().c_str(), "410000000000000000");
+    ASSERT_TRUE(result.isEmpty());
 }
 
 TEST_F(SerializationTest, StringMessageSerializeTest)
@@ -877,6 +879,38 @@ TEST_F(SerializationTest, StringMessageSerializeTest)
     ASSERT_STREQ(result.toHex().toStdString().c_str(), "3280046f6570534e4c4956473038554a706b3257374a74546b6b4278794b303658306c51364d4c37494d6435354b3858433154707363316b4457796d3576387a3638623446517570394f393551536741766a48494131354f583642753638657362514654394c507a5341444a367153474254594248583551535a67333274724364484d6a383058754448717942674d34756636524b71326d675762384f76787872304e774c786a484f66684a384d726664325237686255676a65737062596f5168626748456a32674b45563351766e756d596d7256586531426b437a5a684b56586f6444686a304f6641453637766941793469334f6167316872317a34417a6f384f3558713638504f455a3143735a506f3244584e4e52386562564364594f7a3051364a4c50536c356a61734c434672514e374569564e6a516d437253735a4852674c4e796c76676f454678475978584a39676d4b346d72304f47645a63474a4f5252475a4f514370514d68586d68657a46616c4e494a584d50505861525658695268524150434e55456965384474614357414d717a346e4e5578524d5a355563584258735850736879677a6b7979586e4e575449446f6a466c7263736e4b71536b5131473645383567535a6274495942683773714f36474458486a4f72585661564356435575626a634a4b54686c79736c7432397a48754973354a47707058785831");
 }
 
+TEST_F(SerializationTest, Utf8StringMessageSerializeTest)
+{
+    SimpleStringMessage test;
+    test.setTestFieldString(QString::fromUtf8("\xc3\xa4\xe2\x82\xac\xf0\x9f\x98\x80z"));
+    QByteArray result = test.serialize(serializer.get());
+    ASSERT_STREQ(result.toHex().toStdString().c_str(), "320ac3a4e282acf09f98807a");
+    ASSERT_TRUE(result.mid(2) == test.testFieldString().toUtf8());
+}
+
+TEST_F(SerializationTest, MixedUtf8StringMessageSerializeTest)
+{
+    //Non-ASCII characters are placed on different offsets of ASCII blocks
+    QString value;
+    for (int i = 0; i < 40; ++i) {
+        value += QString(i, QChar('a' + i % 26));
+        value += QString::fromUtf8(i % 2 == 0 ? "\xc3\xa4" : "\xf0\x9f\x98\x80");
+    }
+    value += QString(33, QChar('z'));
+
+    SimpleStringMessage test;
+    test.setTestFieldString(value);
+    const QByteArray utf8 = value.toUtf8();
+    const QByteArray result = test.serialize(serializer.get());
+    ASSERT_EQ(result.size(), utf8.size() + 3);
+    ASSERT_TRUE(result.mid(3) == utf8);
+    ASSERT_STREQ(result.left(3).toHex().toStdString().c_str(), "32a507");
+
+    SimpleStringMessage deserialized;
+    deserialized.deserialize(serializer.get(), result);
+    ASSERT_TRUE(deserialized.testFieldString() == value);
+}
+
 TEST_F(SerializationTest, ComplexTypeSerializeTest)
 {
     SimpleStringMessage stringMsg;
@@ -1302,6 +1336,140 @@ TEST_F(SerializationTest, EmptyStringMessageTest)
     ASSERT_TRUE(result.isEmpty());
 }
 
+TEST_F(SerializationTest, DefaultValuesElisionTest)
+{
+    SimpleDoubleMessage doubleMsg;
+    doubleMsg.setTestFieldDouble(0.0);
+    SimpleFixedInt32Message fixedMsg;
+    fixedMsg.setTestFieldFixedInt32(0);
+    SimpleStringMessage stringMsg;
+    stringMsg.setTestFieldString("");
+    SimpleBytesMessage bytesMsg;
+    bytesMsg.setTestFieldBytes(QByteArray());
+    SimpleIntMessage intMsg;
+    intMsg.setTestFieldInt(0);
+
+    EXPECT_TRUE(serializer->defaultValuesElided());
+    EXPECT_TRUE(doubleMsg.serialize(serializer.get()).isEmpty());
+    EXPECT_TRUE(fixedMsg.serialize(serializer.get()).isEmpty());
+    EXPECT_TRUE(stringMsg.serialize(serializer.get()).isEmpty());
+    EXPECT_TRUE(bytesMsg.serialize(serializer.get()).isEmpty());
+    EXPECT_TRUE(intMsg.serialize(serializer.get()).isEmpty());
+
+    //Repeated elements are always written
+    RepeatedStringMessage repeatedMsg;
+    repeatedMsg.setTestRepeatedString({"", "a"});
+    EXPECT_STREQ(repeatedMsg.serialize(serializer.get()).toHex().toStdString().c_str(), "0a000a0161");
+
+    QProtobufSerializer defaultsSerializer(QProtobufSerializer::WriteDefaultValues);
+    EXPECT_FALSE(defaultsSerializer.defaultValuesElided());
+    EXPECT_STREQ(doubleMsg.serialize(&defaultsSerializer).toHex().toStdString().c_str(), "410000000000000000");
+    EXPECT_STREQ(fixedMsg.serialize(&defaultsSerializer).toHex().toStdString().c_str(), "0d00000000");
+    EXPECT_STREQ(stringMsg.serialize(&defaultsSerializer).toHex().toStdString().c_str(), "3200");
+    //Zero varints are never written
+    EXPECT_TRUE(intMsg.serialize(&defaultsSerializer).isEmpty());
+    //Shared serializer is not affected
+    EXPECT_TRUE(doubleMsg.serialize(serializer.get()).isEmpty());
+}
+
+TEST_F(SerializationTest, MapDefaultKeyValueSerializeTest)
+{
+    SimpleFixed32StringMapMessage test;
+    test.setMapField({{0, {""}}, {10, {"ten"}}});
+    QByteArray result = test.serialize(serializer.get());
+
+    //Default key and value of map entry are written
+    ASSERT_STREQ(result.toHex().toStdString().c_str(),
+                 "3a070d0000000012003a0a0d0a000000120374656e");
+
+    SimpleFixed32StringMapMessage copy;
+    copy.deserialize(serializer.get(), result);
+    EXPECT_TRUE(copy.mapField() == test.mapField());
+
+    SimpleStringStringMapMessage stringTest;
+    stringTest.setMapField({{"", {""}}});
+    result = stringTest.serialize(serializer.get());
+    ASSERT_STREQ(result.toHex().toStdString().c_str(), "6a040a001200");
+
+    SimpleStringStringMapMessage stringCopy;
+    stringCopy.deserialize(serializer.get(), result);
+    EXPECT_TRUE(stringCopy.mapField() == stringTest.mapField());
+}
+
+TEST_F(SerializationTest, AppendToBufferSerializeTest)
+{
+    SimpleStringMessage stringMsg;
+    stringMsg.setTestFieldString("qwerty");
+    QSharedPointer<ComplexMessage> msg(new ComplexMessage);
+    msg->setTestFieldInt(25);
+    msg->setTestComplexField(stringMsg);
+    RepeatedComplexMessage test;
+    test.setTestRepeatedComplex({msg, msg, msg});
+
+    const QByteArray expected = test.serialize(serializer.get());
+    QByteArray result("prefix");
+    test.serialize(serializer.get(), result);
+    ASSERT_TRUE(result == QByteArray("prefix") + expected);
+
+    test.serialize(serializer.get(), result);
+    ASSERT_TRUE(result == QByteArray("prefix") + expected + expected);
+}
+
+TEST_F(SerializationTest, DeviceSerializeTest)
+{
+    SimpleStringMessage stringMsg;
+    stringMsg.setTestFieldString("qwerty");
+    QSharedPointer<ComplexMessage> msg(new ComplexMessage);
+    msg->setTestFieldInt(25);
+    msg->setTestComplexField(stringMsg);
+    RepeatedComplexMessage test;
+    test.setTestRepeatedComplex({msg, msg, msg});
+
+    QBuffer device;
+    device.open(QIODevice::WriteOnly);
+    ASSERT_TRUE(test.serialize(serializer.get(), &device));
+    ASSERT_TRUE(device.data() == test.serialize(serializer.get()));
+
+    //Large message is written by chunks
+    SimpleBytesMessage bytesMsg;
+    bytesMsg.setTestFieldBytes(QByteArray(300000, 'a'));
+    QBuffer largeDevice;
+    largeDevice.open(QIODevice::WriteOnly);
+    ASSERT_TRUE(bytesMsg.serialize(serializer.get(), &largeDevice));
+    ASSERT_TRUE(largeDevice.data() == bytesMsg.serialize(serializer.get()));
+}
+
+TEST_F(SerializationTest, DeterministicFieldOrderTest)
+{
+    SimpleStringMessage stringMsg;
+    stringMsg.setTestFieldString("qwerty");
+
+    ComplexMessage test;
+    test.setTestFieldInt(42);
+    test.setTestComplexField(stringMsg);
+
+    QByteArray result = test.serialize(serializer.get());
+    ASSERT_STREQ(result.toHex().toStdString().c_str(), "082a12083206717765727479");
+}
+
+TEST_F(SerializationTest, ContentHashTest)
+{
+    EXPECT_EQ(QProtobufSerializer::contentHash(QByteArray()), 0xef46db3751d8e999ULL);
+    EXPECT_EQ(QProtobufSerializer::contentHash(QByteArray("abc")), 0x44bc2cf5ad770999ULL);
+    EXPECT_NE(QProtobufSerializer::contentHash(QByteArray("abc"), 1), 0x44bc2cf5ad770999ULL);
+
+    SimpleSInt32StringMapMessage test1;
+    test1.setMapField({{10, {"ten"}}, {-42, {"minus fourty two"}}, {15, {"fifteen"}}});
+    SimpleSInt32StringMapMessage test2;
+    test2.setMapField({{15, {"fifteen"}}, {10, {"ten"}}, {-42, {"minus fourty two"}}});
+    EXPECT_EQ(serializer->hash<SimpleSInt32StringMapMessage>(&test1),
+              serializer->hash<SimpleSInt32StringMapMessage>(&test2));
+
+    test2.setMapField({{15, {"fifteen"}}, {10, {"ten"}}});
+    EXPECT_NE(serializer->hash<SimpleSInt32StringMapMessage>(&test1),
+              serializer->hash<SimpleSInt32StringMapMessage>(&test2));
+}
+
 TEST_F(SerializationTest, DISABLED_BenchmarkTest)
 {
     qtprotobufnamespace::tests::SimpleIntMessage msg;
@@ -1310,3 +1478,73 @@ TEST_F(SerializationTest, DISABLED_BenchmarkTest)
         msg.serialize(serializer.get());
     }
 }
+
+TEST_F(SerializationTest, DISABLED_MultithreadedSerializationBenchmarkTest)
+{
+    //Nested message and map fields are serialized using registered handlers
+    const int iterations = 100000;
+    SimpleStringMessage stringMsg;
+    stringMsg.setTestFieldString("qwerty");
+    ComplexMessage complexMsg;
+    complexMsg.setTestFieldInt(42);
+    complexMsg.setTestComplexField(stringMsg);
+    SimpleSInt32StringMapMessage mapMsg;
+    mapMsg.setMapField({{10, {"ten"}}, {-42, {"minus fourty two"}}, {15, {"fifteen"}}});
+    const QByteArray complexData = complexMsg.serialize(serializer.get());
+    const QByteArray mapData = mapMsg.serialize(serializer.get());
+
+    //Every thread serializes the same messages the same number of times
+    auto measure = [&](int threadCount) -> qint64 {
+        std::vector<std::thread> threads;
+        std::vector<int> matches(threadCount, 0);
+        const qint64 elapsed = measureNsecs(1, [&]() {
+            for (int i = 0; i < threadCount; ++i) {
+                threads.emplace_back([&, i]() {
+                    QProtobufSerializer threadSerializer;
+                    bool match = true;
+                    for (int j = 0; j < iterations; ++j) {
+                        match = complexMsg.serialize(&threadSerializer) == complexData
+                                && mapMsg.serialize(&threadSerializer) == mapData && match;
+                    }
+                    matches[i] = match;
+                });
+            }
+            for (auto &thread : threads) {
+                thread.join();
+            }
+        });
+        for (int match : matches) {
+            EXPECT_TRUE(match);
+        }
+        return elapsed;
+    };
+
+    const int threadCount = static_cast<int>(std::min(4u, std::thread::hardware_concurrency()));
+    if (threadCount < 2) {
+        return;
+    }
+
+    //Handler lookups don't take locks, so threads running in parallel take about the same time as a single one
+    reportTime("singleThreadTime", measure(1));
+    reportTime("multiThreadTime", measure(threadCount));
+}
+
+TEST_F(SerializationTest, MetaObjectFieldsTest)
+{
+    const std::vector<QProtobufMetaProperty> &fields = ComplexMessage::protobufMetaObject.fields();
+    ASSERT_EQ(fields.size(), 2u);
+    EXPECT_EQ(&fields, &ComplexMessage::protobufMetaObject.fields());
+
+    //Fields are sorted by field number and resolved to properties of the message
+    EXPECT_EQ(fields[0].protoFieldIndex(), 1);
+    EXPECT_TRUE(fields[0].jsonPropertyName() == QString("testFieldInt"));
+    EXPECT_EQ(fields[0].propertyIndex(), ComplexMessage::staticMetaObject.indexOfProperty("testFieldInt"));
+    EXPECT_EQ(fields[1].protoFieldIndex(), 2);
+    EXPECT_TRUE(fields[1].jsonPropertyName() == QString("testComplexField"));
+    EXPECT_EQ(fields[1].propertyIndex(), ComplexMessage::staticMetaObject.indexOfProperty("testComplexField"));
+
+    ComplexMessage test;
+    test.setTestFieldInt(42);
+    EXPECT_EQ(fields[0].read(&test).value<int32>(), 42);
+    EXPECT_TRUE(test.serialize(serializer.get()).startsWith(QByteArray::fromHex("082a")));
+}
@@ -26,6 +26,8 @@
 #include "serializationplugintest.h"
 #include "qprotobufserializerregistry_p.h"
 
+#include <thread>
+
 using namespace QtProtobuf::tests;
 using namespace QtProtobuf;
 
@@ -78,3 +80,24 @@ TEST_F(SerializationPluginTest, UnknownPluginLoadedSerializeTest)
 {
     ASSERT_ANY_THROW(QProtobufSerializerRegistry::instance().getSerializer("SomeName", loadedTestPlugin));
 }
+
+TEST_F(SerializationPluginTest, AcquireSerializerTest)
+{
+    auto serializer = QProtobufSerializerRegistry::instance().acquireSerializer(ProtobufSerializator);
+    ASSERT_NE(serializer.get(), nullptr);
+    EXPECT_EQ(serializer, QProtobufSerializerRegistry::instance().acquireSerializer(ProtobufSerializator));
+    EXPECT_NE(serializer, QProtobufSerializerRegistry::instance().getSerializer(ProtobufSerializator));
+    EXPECT_NE(serializer, QProtobufSerializerRegistry::instance().acquireSerializer(JsonSerializator));
+
+    std::shared_ptr<QAbstractProtobufSerializer> threadSerializer;
+    std::thread thread([&threadSerializer]() {
+        threadSerializer = QProtobufSerializerRegistry::instance().acquireSerializer(ProtobufSerializator);
+    });
+    thread.join();
+    ASSERT_NE(threadSerializer.get(), nullptr);
+    EXPECT_NE(serializer, threadSerializer);
+
+    EXPECT_NE(QProtobufSerializerRegistry::instance().acquireSerializer(ProtobufSerializator, loadedTestPlugin).get(), nullptr);
+    EXPECT_THROW(QProtobufSerializerRegistry::instance().acquireSerializer("SomeName"), std::out_of_range);
+    EXPECT_THROW(QProtobufSerializerRegistry::instance().acquireSerializer("SomeName", loadedTestPlugin), std::out_of_range);
+}